@@ -1634,6 +1634,398 @@ static HRESULT remap_faces_for_attrsort(struct d3dx9_mesh *This, const DWORD *in
     return D3D_OK;
 }
 
+#define VCACHE_SIZE 32
+#define VCACHE_MAX_VALENCE_SCORE 32
+
+struct vcache_vertex
+{
+    float score;
+    int cache_pos;
+    DWORD remaining;  /* faces using the vertex that are not emitted yet */
+    DWORD face_start; /* first entry in the face list */
+    DWORD face_count;
+};
+
+struct vcache_scores
+{
+    float cache[VCACHE_SIZE];
+    float valence[VCACHE_MAX_VALENCE_SCORE];
+};
+
+static void init_vcache_scores(struct vcache_scores *scores)
+{
+    unsigned int i;
+
+    /* The last three vertices used get a fixed score, so that the order
+     * within the previous face doesn't matter. */
+    for (i = 0; i < VCACHE_SIZE; i++)
+        scores->cache[i] = i < 3 ? 0.75f : powf(1.0f - (i - 3) * (1.0f / (VCACHE_SIZE - 3)), 1.5f);
+    scores->valence[0] = 0.0f;
+    for (i = 1; i < VCACHE_MAX_VALENCE_SCORE; i++)
+        scores->valence[i] = 2.0f * powf(i, -0.5f);
+}
+
+static float vcache_vertex_score(const struct vcache_scores *scores, const struct vcache_vertex *vertex)
+{
+    float score;
+
+    if (!vertex->remaining)
+        return -1.0f;
+
+    score = vertex->cache_pos >= 0 ? scores->cache[vertex->cache_pos] : 0.0f;
+    if (vertex->remaining < VCACHE_MAX_VALENCE_SCORE)
+        score += scores->valence[vertex->remaining];
+    else
+        score += 2.0f * powf(vertex->remaining, -0.5f);
+    return score;
+}
+
+/* Reorders the faces in 'faces' for the post-transform vertex cache, using
+ * Tom Forsyth's linear-speed vertex cache optimisation. The vertices array
+ * must have 'face_start' set to ~0u and 'cache_pos' set to -1 for all
+ * vertices on entry, and is left that way. */
+static HRESULT optimize_faces_for_vertex_cache(const DWORD *indices, DWORD *faces, DWORD face_count,
+        struct vcache_vertex *vertices, const struct vcache_scores *scores)
+{
+    DWORD cache[VCACHE_SIZE + 3], new_cache[VCACHE_SIZE + 3];
+    DWORD cache_size = 0, new_cache_size;
+    DWORD *face_list, *face_order;
+    float *face_scores;
+    BOOL *emitted;
+    DWORD list_size = 0, cursor = 0, emitted_count, i, j, k;
+    HRESULT hr = D3D_OK;
+    int best;
+
+    face_list = HeapAlloc(GetProcessHeap(), 0, face_count * 3 * sizeof(*face_list));
+    face_order = HeapAlloc(GetProcessHeap(), 0, face_count * sizeof(*face_order));
+    face_scores = HeapAlloc(GetProcessHeap(), 0, face_count * sizeof(*face_scores));
+    emitted = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, face_count * sizeof(*emitted));
+    if (!face_list || !face_order || !face_scores || !emitted)
+    {
+        hr = E_OUTOFMEMORY;
+        goto cleanup;
+    }
+
+    /* Build the list of faces using each vertex. */
+    for (i = 0; i < face_count * 3; i++)
+        vertices[indices[faces[i / 3] * 3 + i % 3]].remaining++;
+    for (i = 0; i < face_count * 3; i++)
+    {
+        struct vcache_vertex *vertex = &vertices[indices[faces[i / 3] * 3 + i % 3]];
+
+        if (vertex->face_start == ~0u)
+        {
+            vertex->face_start = list_size;
+            list_size += vertex->remaining;
+        }
+        face_list[vertex->face_start + vertex->face_count++] = i / 3;
+    }
+    for (i = 0; i < face_count * 3; i++)
+    {
+        struct vcache_vertex *vertex = &vertices[indices[faces[i / 3] * 3 + i % 3]];
+        vertex->score = vcache_vertex_score(scores, vertex);
+    }
+
+    best = -1;
+    for (i = 0; i < face_count; i++)
+    {
+        const DWORD *face = &indices[faces[i] * 3];
+
+        face_scores[i] = vertices[face[0]].score + vertices[face[1]].score + vertices[face[2]].score;
+        if (best < 0 || face_scores[i] > face_scores[best])
+            best = i;
+    }
+
+    for (emitted_count = 0; emitted_count < face_count; emitted_count++)
+    {
+        const DWORD *face;
+
+        if (best < 0)
+        {
+            /* Nothing in the cache is connected to remaining faces, start over
+             * from the next face in the original order. */
+            while (emitted[cursor])
+                cursor++;
+            best = cursor;
+        }
+
+        face_order[emitted_count] = faces[best];
+        emitted[best] = TRUE;
+        face = &indices[faces[best] * 3];
+
+        /* Move the face vertices to the front of the cache. */
+        new_cache_size = 0;
+        for (j = 0; j < 3; j++)
+        {
+            for (k = 0; k < new_cache_size; k++)
+                if (new_cache[k] == face[j])
+                    break;
+            if (k == new_cache_size)
+                new_cache[new_cache_size++] = face[j];
+            vertices[face[j]].remaining--;
+        }
+        for (j = 0; j < cache_size; j++)
+        {
+            if (cache[j] != face[0] && cache[j] != face[1] && cache[j] != face[2])
+                new_cache[new_cache_size++] = cache[j];
+        }
+
+        /* Update the scores of everything in the cache, including the
+         * vertices that just fell out of it. */
+        best = -1;
+        for (j = 0; j < new_cache_size; j++)
+        {
+            struct vcache_vertex *vertex = &vertices[new_cache[j]];
+
+            vertex->cache_pos = j < VCACHE_SIZE ? j : -1;
+            vertex->score = vcache_vertex_score(scores, vertex);
+        }
+        for (j = 0; j < new_cache_size; j++)
+        {
+            const struct vcache_vertex *vertex = &vertices[new_cache[j]];
+
+            for (k = 0; k < vertex->face_count; k++)
+            {
+                DWORD f = face_list[vertex->face_start + k];
+                const DWORD *other = &indices[faces[f] * 3];
+
+                if (emitted[f])
+                    continue;
+                face_scores[f] = vertices[other[0]].score + vertices[other[1]].score + vertices[other[2]].score;
+                if (best < 0 || face_scores[f] > face_scores[best])
+                    best = f;
+            }
+        }
+
+        cache_size = min(new_cache_size, VCACHE_SIZE);
+        memcpy(cache, new_cache, cache_size * sizeof(*cache));
+    }
+
+    memcpy(faces, face_order, face_count * sizeof(*faces));
+
+cleanup:
+    /* Reset the vertices used by these faces for the next call. */
+    for (i = 0; i < face_count * 3; i++)
+    {
+        struct vcache_vertex *vertex = &vertices[indices[faces[i / 3] * 3 + i % 3]];
+
+        vertex->cache_pos = -1;
+        vertex->remaining = 0;
+        vertex->face_start = ~0u;
+        vertex->face_count = 0;
+    }
+    HeapFree(GetProcessHeap(), 0, emitted);
+    HeapFree(GetProcessHeap(), 0, face_scores);
+    HeapFree(GetProcessHeap(), 0, face_order);
+    HeapFree(GetProcessHeap(), 0, face_list);
+    return hr;
+}
+
+/* Reorders the faces in 'faces' into runs of adjacent faces. Each run is
+ * continued through the unvisited neighbour that has the fewest unvisited
+ * neighbours itself, which keeps runs from cutting the remaining faces
+ * into small islands. Only neighbours for which in_range is set are
+ * followed; 'visited' must be clear for those faces. */
+static HRESULT optimize_faces_for_strips(const DWORD *adjacency, DWORD *faces, DWORD face_count,
+        const BOOL *in_range, BOOL *visited)
+{
+    DWORD *face_order, emitted_count = 0, cursor = 0, i, j;
+
+    face_order = HeapAlloc(GetProcessHeap(), 0, face_count * sizeof(*face_order));
+    if (!face_order)
+        return E_OUTOFMEMORY;
+
+    while (emitted_count < face_count)
+    {
+        DWORD face;
+
+        while (visited[faces[cursor]])
+            cursor++;
+        face = faces[cursor];
+
+        for (;;)
+        {
+            DWORD next = ~0u, next_count = 4;
+
+            visited[face] = TRUE;
+            face_order[emitted_count++] = face;
+
+            for (i = 0; i < 3; i++)
+            {
+                DWORD neighbour = adjacency[face * 3 + i], count = 0;
+
+                if (neighbour == ~0u || !in_range[neighbour] || visited[neighbour])
+                    continue;
+                for (j = 0; j < 3; j++)
+                {
+                    DWORD other = adjacency[neighbour * 3 + j];
+                    if (other != ~0u && in_range[other] && !visited[other])
+                        count++;
+                }
+                if (count < next_count)
+                {
+                    next = neighbour;
+                    next_count = count;
+                }
+            }
+            if (next == ~0u)
+                break;
+            face = next;
+        }
+    }
+
+    memcpy(faces, face_order, face_count * sizeof(*faces));
+    HeapFree(GetProcessHeap(), 0, face_order);
+    return D3D_OK;
+}
+
+/* Reorders the faces within each attribute range for D3DXMESHOPT_VERTEXCACHE
+ * or D3DXMESHOPT_STRIPREORDER. face_remap holds the attribute sorted order on
+ * entry. */
+static HRESULT remap_faces_for_vertex_order(struct d3dx9_mesh *This, DWORD flags, const DWORD *indices,
+        const DWORD *adjacency, const DWORD *sorted_attrib_buffer, DWORD *face_remap)
+{
+    struct vcache_vertex *vertices = NULL;
+    struct vcache_scores scores;
+    BOOL *in_range = NULL, *visited = NULL;
+    DWORD *faces, start, end, i;
+    HRESULT hr = D3D_OK;
+
+    if (!(faces = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*faces))))
+        return E_OUTOFMEMORY;
+    for (i = 0; i < This->numfaces; i++)
+        faces[face_remap[i]] = i;
+
+    if (flags & D3DXMESHOPT_VERTEXCACHE)
+    {
+        if (!(vertices = HeapAlloc(GetProcessHeap(), 0, This->numvertices * sizeof(*vertices))))
+        {
+            hr = E_OUTOFMEMORY;
+            goto cleanup;
+        }
+        for (i = 0; i < This->numvertices; i++)
+        {
+            vertices[i].cache_pos = -1;
+            vertices[i].remaining = 0;
+            vertices[i].face_start = ~0u;
+            vertices[i].face_count = 0;
+        }
+        init_vcache_scores(&scores);
+    }
+    else
+    {
+        in_range = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, This->numfaces * sizeof(*in_range));
+        visited = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, This->numfaces * sizeof(*visited));
+        if (!in_range || !visited)
+        {
+            hr = E_OUTOFMEMORY;
+            goto cleanup;
+        }
+    }
+
+    for (start = 0; start < This->numfaces; start = end)
+    {
+        for (end = start + 1; end < This->numfaces; end++)
+            if (sorted_attrib_buffer[end] != sorted_attrib_buffer[start])
+                break;
+
+        if (flags & D3DXMESHOPT_VERTEXCACHE)
+        {
+            hr = optimize_faces_for_vertex_cache(indices, faces + start, end - start, vertices, &scores);
+        }
+        else
+        {
+            for (i = start; i < end; i++)
+                in_range[faces[i]] = TRUE;
+            hr = optimize_faces_for_strips(adjacency, faces + start, end - start, in_range, visited);
+            for (i = start; i < end; i++)
+                in_range[faces[i]] = FALSE;
+        }
+        if (FAILED(hr))
+            goto cleanup;
+    }
+
+    for (i = 0; i < This->numfaces; i++)
+        face_remap[faces[i]] = i;
+
+cleanup:
+    HeapFree(GetProcessHeap(), 0, visited);
+    HeapFree(GetProcessHeap(), 0, in_range);
+    HeapFree(GetProcessHeap(), 0, vertices);
+    HeapFree(GetProcessHeap(), 0, faces);
+    return hr;
+}
+
+/* Creates a vertex_remap that orders the vertices by first use in the new
+ * face order. Unused vertices are moved to the end, or dropped when compacting,
+ * and new_num_vertices is set accordingly. Indices are updated according to the
+ * vertex_remap. */
+static HRESULT remap_vertices_for_face_order(struct d3dx9_mesh *This, DWORD *indices,
+        const DWORD *face_remap, BOOL compact, DWORD *new_num_vertices, ID3DXBuffer **vertex_remap)
+{
+    DWORD *vertex_remap_ptr, *new_index, *faces;
+    DWORD next = 0, num_used_vertices, i, j;
+    HRESULT hr;
+
+    if (!(faces = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*faces))))
+        return E_OUTOFMEMORY;
+    if (!(new_index = HeapAlloc(GetProcessHeap(), 0, This->numvertices * sizeof(*new_index))))
+    {
+        HeapFree(GetProcessHeap(), 0, faces);
+        return E_OUTOFMEMORY;
+    }
+
+    hr = D3DXCreateBuffer(This->numvertices * sizeof(DWORD), vertex_remap);
+    if (FAILED(hr)) goto cleanup;
+    vertex_remap_ptr = ID3DXBuffer_GetBufferPointer(*vertex_remap);
+
+    for (i = 0; i < This->numfaces; i++)
+        faces[face_remap[i]] = i;
+    for (i = 0; i < This->numvertices; i++)
+        new_index[i] = ~0u;
+
+    /* create old->new vertex mapping */
+    for (i = 0; i < This->numfaces; i++)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            DWORD index = indices[faces[i] * 3 + j];
+            if (new_index[index] == ~0u)
+                new_index[index] = next++;
+        }
+    }
+    num_used_vertices = next;
+    for (i = 0; i < This->numvertices; i++)
+    {
+        if (new_index[i] == ~0u)
+            new_index[i] = next++;
+    }
+
+    /* convert indices */
+    for (i = 0; i < This->numfaces * 3; i++)
+        indices[i] = new_index[indices[i]];
+
+    /* create new->old vertex mapping */
+    for (i = 0; i < This->numvertices; i++)
+        vertex_remap_ptr[new_index[i]] = i;
+
+    if (compact)
+    {
+        for (i = num_used_vertices; i < This->numvertices; i++)
+            vertex_remap_ptr[i] = -1;
+        *new_num_vertices = num_used_vertices;
+    }
+    else
+    {
+        *new_num_vertices = This->numvertices;
+    }
+
+cleanup:
+    HeapFree(GetProcessHeap(), 0, new_index);
+    HeapFree(GetProcessHeap(), 0, faces);
+    return hr;
+}
+
 static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags, const DWORD *adjacency_in,
         DWORD *adjacency_out, DWORD *face_remap_out, ID3DXBuffer **vertex_remap_out)
 {
@@ -1660,14 +2052,9 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
     if ((flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER)) == (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
         return D3DERR_INVALIDCALL;
 
+    /* Faces are only reordered within attribute ranges. */
     if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
-    {
-        if (flags & D3DXMESHOPT_VERTEXCACHE)
-            FIXME("D3DXMESHOPT_VERTEXCACHE not implemented.\n");
-        if (flags & D3DXMESHOPT_STRIPREORDER)
-            FIXME("D3DXMESHOPT_STRIPREORDER not implemented.\n");
-        return E_NOTIMPL;
-    }
+        flags |= D3DXMESHOPT_ATTRSORT;
 
     hr = iface->lpVtbl->LockIndexBuffer(iface, 0, &indices);
     if (FAILED(hr)) goto cleanup;
@@ -1688,7 +2075,7 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
         hr = compact_mesh(This, dword_indices, &new_num_vertices, &vertex_remap);
         if (FAILED(hr)) goto cleanup;
     } else if (flags & D3DXMESHOPT_ATTRSORT) {
-        if (!(flags & D3DXMESHOPT_IGNOREVERTS))
+        if (!(flags & (D3DXMESHOPT_IGNOREVERTS | D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER)))
             FIXME("D3DXMESHOPT_ATTRSORT vertex reordering not implemented.\n");
 
         hr = iface->lpVtbl->LockAttributeBuffer(iface, 0, &attrib_buffer);
@@ -1696,6 +2083,21 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
 
         hr = remap_faces_for_attrsort(This, dword_indices, attrib_buffer, &sorted_attrib_buffer, &face_remap);
         if (FAILED(hr)) goto cleanup;
+
+        if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
+        {
+            hr = remap_faces_for_vertex_order(This, flags, dword_indices, adjacency_in,
+                    sorted_attrib_buffer, face_remap);
+            if (FAILED(hr)) goto cleanup;
+
+            if (!(flags & D3DXMESHOPT_IGNOREVERTS))
+            {
+                new_num_alloc_vertices = This->numvertices;
+                hr = remap_vertices_for_face_order(This, dword_indices, face_remap,
+                        flags & D3DXMESHOPT_COMPACT, &new_num_vertices, &vertex_remap);
+                if (FAILED(hr)) goto cleanup;
+            }
+        }
     }
 
     if (vertex_remap)
@@ -1785,12 +2187,10 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
 
     if (adjacency_out) {
         if (face_remap) {
-            for (i = 0; i < This->numfaces; i++) {
-                DWORD old_pos = i * 3;
-                DWORD new_pos = face_remap[i] * 3;
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
+            for (i = 0; i < This->numfaces * 3; i++) {
+                DWORD new_pos = face_remap[i / 3] * 3 + i % 3;
+                DWORD neighbour = adjacency_in[i];
+                adjacency_out[new_pos] = neighbour == ~0u ? ~0u : face_remap[neighbour];
             }
         } else {
             memcpy(adjacency_out, adjacency_in, This->numfaces * 3 * sizeof(*adjacency_out));
@@ -242,6 +242,10 @@ struct d3dx_pres_operand
 {
     struct d3dx_pres_reg reg;
     struct d3dx_pres_reg index_reg;
+    /* Address of the first component for operands without relative addressing
+       in floating point tables, set once the register tables are allocated. */
+    void *direct;
+    BOOL direct_double;
 };
 
 #define MAX_INPUTS_COUNT 8
@@ -1220,6 +1224,34 @@ static HRESULT parse_preshader(struct d3dx_preshader *pres, unsigned int *ptr, u
     return D3D_OK;
 }
 
+static void resolve_operand(struct d3dx_regstore *rs, struct d3dx_pres_operand *opr)
+{
+    enum pres_value_type type = table_info[opr->reg.table].type;
+
+    opr->direct = NULL;
+    if (opr->index_reg.table != PRES_REGTAB_COUNT || (type != PRES_VT_FLOAT && type != PRES_VT_DOUBLE))
+        return;
+
+    opr->direct = (BYTE *)rs->tables[opr->reg.table] + table_info[opr->reg.table].component_size * opr->reg.offset;
+    opr->direct_double = type == PRES_VT_DOUBLE;
+}
+
+/* Register indices of operands without relative addressing are validated in
+ * parse_preshader(), so those can be accessed directly. */
+static void resolve_preshader_registers(struct d3dx_preshader *pres)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < pres->ins_count; ++i)
+    {
+        struct d3dx_pres_ins *ins = &pres->ins[i];
+
+        for (j = 0; j < pres_op_info[ins->op].input_count; ++j)
+            resolve_operand(&pres->regs, &ins->inputs[j]);
+        resolve_operand(&pres->regs, &ins->output);
+    }
+}
+
 HRESULT d3dx_create_param_eval(struct d3dx_effect *effect, void *byte_code, unsigned int byte_code_size,
         D3DXPARAMETER_TYPE type, struct d3dx_param_eval **peval_out, ULONG64 *version_counter,
         const char **skip_constants, unsigned int skip_constants_count)
@@ -1305,6 +1337,7 @@ HRESULT d3dx_create_param_eval(struct d3dx_effect *effect, void *byte_code, unsi
         if (FAILED(ret = regstore_alloc_table(&peval->pres.regs, i)))
             goto err_out;
     }
+    resolve_preshader_registers(&peval->pres);
 
     if (TRACE_ON(d3dx))
     {
@@ -1645,6 +1678,23 @@ static void exec_set_arg(struct d3dx_regstore *rs, const struct d3dx_pres_reg *r
     regstore_set_double(rs, reg->table, reg->offset + comp, res);
 }
 
+static inline double exec_get_operand(struct d3dx_regstore *rs, const struct d3dx_pres_operand *opr,
+        unsigned int comp)
+{
+    if (opr->direct)
+        return opr->direct_double ? ((double *)opr->direct)[comp] : ((float *)opr->direct)[comp];
+    return exec_get_arg(rs, opr, comp);
+}
+
+static inline void exec_set_operand(struct d3dx_regstore *rs, const struct d3dx_pres_operand *opr,
+        unsigned int comp, double res)
+{
+    if (opr->direct && !opr->direct_double)
+        ((float *)opr->direct)[comp] = res;
+    else
+        exec_set_arg(rs, &opr->reg, comp, res);
+}
+
 #define ARGS_ARRAY_SIZE 8
 static HRESULT execute_preshader(struct d3dx_preshader *pres)
 {
@@ -1668,21 +1718,22 @@ static HRESULT execute_preshader(struct d3dx_preshader *pres)
             }
             for (k = 0; k < oi->input_count; ++k)
                 for (j = 0; j < ins->component_count; ++j)
-                    args[k * ins->component_count + j] = exec_get_arg(&pres->regs, &ins->inputs[k],
+                    args[k * ins->component_count + j] = exec_get_operand(&pres->regs, &ins->inputs[k],
                             ins->scalar_op && !k ? 0 : j);
             res = oi->func(args, ins->component_count);
 
             /* only 'dot' instruction currently falls here */
-            exec_set_arg(&pres->regs, &ins->output.reg, 0, res);
+            exec_set_operand(&pres->regs, &ins->output, 0, res);
         }
         else
         {
+            /* Components are written one at a time, the output may overlap the inputs. */
             for (j = 0; j < ins->component_count; ++j)
             {
                 for (k = 0; k < oi->input_count; ++k)
-                    args[k] = exec_get_arg(&pres->regs, &ins->inputs[k], ins->scalar_op && !k ? 0 : j);
+                    args[k] = exec_get_operand(&pres->regs, &ins->inputs[k], ins->scalar_op && !k ? 0 : j);
                 res = oi->func(args, ins->component_count);
-                exec_set_arg(&pres->regs, &ins->output.reg, j, res);
+                exec_set_operand(&pres->regs, &ins->output, j, res);
             }
         }
     }
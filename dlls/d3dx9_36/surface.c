@@ -1636,6 +1636,125 @@ static void format_from_vec4(const struct pixel_format_desc *format, const struc
     }
 }
 
+/************************************************************
+ * Direct conversions between common pixel formats
+ *
+ * These produce the same results as the generic
+ * get_relevant_argb_components() / make_argb_color() path, without
+ * going through the per-channel bit twiddling for each pixel.
+ */
+enum fast_conversion_type
+{
+    FAST_CONVERSION_NONE,
+    FAST_CONVERSION_COPY,
+    FAST_CONVERSION_ARGB8888,
+};
+
+struct fast_conversion_info
+{
+    enum fast_conversion_type type;
+    UINT bytes_per_pixel;
+    BOOL swap_rb;
+    DWORD mask, set;
+};
+
+static BOOL is_argb8888_format(const struct pixel_format_desc *format)
+{
+    if (format->type != FORMAT_ARGB || format->bytes_per_pixel != 4 || format->to_rgba || format->from_rgba)
+        return FALSE;
+    if (format->bits[0] && (format->bits[0] != 8 || format->shift[0] != 24))
+        return FALSE;
+    if (format->bits[1] != 8 || format->bits[2] != 8 || format->bits[3] != 8 || format->shift[2] != 8)
+        return FALSE;
+    return (format->shift[1] == 16 && !format->shift[3]) || (!format->shift[1] && format->shift[3] == 16);
+}
+
+static BOOL uses_all_bits(const struct pixel_format_desc *format)
+{
+    return format->bits[0] + format->bits[1] + format->bits[2] + format->bits[3] == format->bytes_per_pixel * 8;
+}
+
+static void init_fast_conversion_info(const struct pixel_format_desc *src_format,
+        const struct pixel_format_desc *dst_format, D3DCOLOR color_key, struct fast_conversion_info *info)
+{
+    info->type = FAST_CONVERSION_NONE;
+    info->bytes_per_pixel = dst_format->bytes_per_pixel;
+
+    if (color_key)
+        return;
+
+    if (is_argb8888_format(src_format) && is_argb8888_format(dst_format))
+    {
+        info->type = FAST_CONVERSION_ARGB8888;
+        info->swap_rb = src_format->shift[1] != dst_format->shift[1];
+        /* Missing alpha in the source is set to its maximum value, unused bits
+         * in the destination are cleared. */
+        info->mask = dst_format->bits[0] ? ~0u : 0x00ffffff;
+        info->set = dst_format->bits[0] && !src_format->bits[0] ? 0xff000000 : 0;
+    }
+    else if (src_format->format == dst_format->format && src_format->type == FORMAT_ARGB
+            && !src_format->to_rgba && !src_format->from_rgba
+            && src_format->bytes_per_pixel <= 4 && uses_all_bits(src_format))
+    {
+        info->type = FAST_CONVERSION_COPY;
+    }
+}
+
+static inline DWORD convert_argb8888(const struct fast_conversion_info *info, DWORD v)
+{
+    if (info->swap_rb)
+        v = (v & 0xff00ff00) | ((v >> 16) & 0xff) | ((v & 0xff) << 16);
+    return (v & info->mask) | info->set;
+}
+
+static void fast_convert_row(const struct fast_conversion_info *info, const BYTE *src, BYTE *dst, UINT count)
+{
+    UINT x;
+    DWORD v;
+
+    if (info->type == FAST_CONVERSION_COPY)
+    {
+        memcpy(dst, src, count * info->bytes_per_pixel);
+        return;
+    }
+
+    /* Keep the loops trivial so that the compiler can vectorize them. */
+    if (info->swap_rb)
+    {
+        for (x = 0; x < count; ++x)
+        {
+            memcpy(&v, src + x * 4, sizeof(v));
+            v = (v & 0xff00ff00) | ((v >> 16) & 0xff) | ((v & 0xff) << 16);
+            v = (v & info->mask) | info->set;
+            memcpy(dst + x * 4, &v, sizeof(v));
+        }
+    }
+    else
+    {
+        for (x = 0; x < count; ++x)
+        {
+            memcpy(&v, src + x * 4, sizeof(v));
+            v = (v & info->mask) | info->set;
+            memcpy(dst + x * 4, &v, sizeof(v));
+        }
+    }
+}
+
+static void fast_convert_pixel(const struct fast_conversion_info *info, const BYTE *src, BYTE *dst)
+{
+    DWORD v;
+
+    if (info->type == FAST_CONVERSION_COPY)
+    {
+        memcpy(dst, src, info->bytes_per_pixel);
+        return;
+    }
+
+    memcpy(&v, src, sizeof(v));
+    v = convert_argb8888(info, v);
+    memcpy(dst, &v, sizeof(v));
+}
+
 /************************************************************
  * copy_pixels
  *
@@ -1681,9 +1800,11 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
 {
     struct argb_conversion_info conv_info, ck_conv_info;
     const struct pixel_format_desc *ck_format = NULL;
+    struct fast_conversion_info fast_info;
     DWORD channels[4];
     UINT min_width, min_height, min_depth;
     UINT x, y, z;
+    BOOL simple;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
             "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
@@ -1692,6 +1813,10 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
 
     ZeroMemory(channels, sizeof(channels));
     init_argb_conversion_info(src_format, dst_format, &conv_info);
+    init_fast_conversion_info(src_format, dst_format, color_key, &fast_info);
+    simple = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
 
     min_width = min(src_size->width, dst_size->width);
     min_height = min(src_size->height, dst_size->height);
@@ -1712,10 +1837,16 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
             const BYTE *src_ptr = src_slice_ptr + y * src_row_pitch;
             BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
 
-            for (x = 0; x < min_width; x++) {
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+            x = 0;
+            if (fast_info.type != FAST_CONVERSION_NONE)
+            {
+                fast_convert_row(&fast_info, src_ptr, dst_ptr, min_width);
+                dst_ptr += min_width * dst_format->bytes_per_pixel;
+                x = min_width;
+            }
+
+            for (; x < min_width; x++) {
+                if (simple)
                 {
                     DWORD val;
 
@@ -1789,8 +1920,10 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
 {
     struct argb_conversion_info conv_info, ck_conv_info;
     const struct pixel_format_desc *ck_format = NULL;
+    struct fast_conversion_info fast_info;
     DWORD channels[4];
     UINT x, y, z;
+    BOOL simple;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
             "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
@@ -1799,6 +1932,10 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
 
     ZeroMemory(channels, sizeof(channels));
     init_argb_conversion_info(src_format, dst_format, &conv_info);
+    init_fast_conversion_info(src_format, dst_format, color_key, &fast_info);
+    simple = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
 
     if (color_key)
     {
@@ -1821,9 +1958,11 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
             {
                 const BYTE *src_ptr = src_row_ptr + (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel;
 
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+                if (fast_info.type != FAST_CONVERSION_NONE)
+                {
+                    fast_convert_pixel(&fast_info, src_ptr, dst_ptr);
+                }
+                else if (simple)
                 {
                     DWORD val;
 
@@ -1874,6 +2013,138 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     }
 }
 
+/************************************************************
+ * can_box_filter_argb_pixels
+ *
+ * Returns TRUE if the destination is an exact 2:1 reduction of the
+ * source in each dimension, as is the case when generating mip levels.
+ */
+BOOL can_box_filter_argb_pixels(const struct volume *src_size, const struct volume *dst_size)
+{
+    return (src_size->width == dst_size->width * 2 || (src_size->width == 1 && dst_size->width == 1))
+            && (src_size->height == dst_size->height * 2 || (src_size->height == 1 && dst_size->height == 1))
+            && (src_size->depth == dst_size->depth * 2 || (src_size->depth == 1 && dst_size->depth == 1));
+}
+
+/************************************************************
+ * box_filter_argb_pixels
+ *
+ * Copies the source buffer to the destination buffer, performing
+ * any necessary format conversion and color keying, averaging each
+ * 2x2(x2) block of source pixels into one destination pixel.
+ * Sizes must be compatible as per can_box_filter_argb_pixels().
+ * For such sizes a linear filter samples the same pixels with
+ * the same weights.
+ */
+void box_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch, const struct volume *src_size,
+        const struct pixel_format_desc *src_format, BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch,
+        const struct volume *dst_size, const struct pixel_format_desc *dst_format, D3DCOLOR color_key,
+        const PALETTEENTRY *palette)
+{
+    const struct pixel_format_desc *ck_format = NULL;
+    struct fast_conversion_info fast_info;
+    UINT step_x, step_y, step_z, count;
+    UINT x, y, z, i, j, k, c;
+
+    TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
+            "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
+            src, src_row_pitch, src_slice_pitch, src_size, src_format, dst, dst_row_pitch, dst_slice_pitch, dst_size,
+            dst_format, color_key, palette);
+
+    init_fast_conversion_info(src_format, dst_format, color_key, &fast_info);
+
+    if (color_key)
+    {
+        /* Color keys are always represented in D3DFMT_A8R8G8B8 format. */
+        ck_format = get_format_info(D3DFMT_A8R8G8B8);
+    }
+
+    step_x = src_size->width / dst_size->width;
+    step_y = src_size->height / dst_size->height;
+    step_z = src_size->depth / dst_size->depth;
+    count = step_x * step_y * step_z;
+
+    for (z = 0; z < dst_size->depth; z++)
+    {
+        BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
+        const BYTE *src_slice_ptr = src + z * step_z * src_slice_pitch;
+
+        for (y = 0; y < dst_size->height; y++)
+        {
+            BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
+            const BYTE *src_row_ptr = src_slice_ptr + y * step_y * src_row_pitch;
+
+            for (x = 0; x < dst_size->width; x++)
+            {
+                const BYTE *src_ptr = src_row_ptr + x * step_x * src_format->bytes_per_pixel;
+
+                if (fast_info.type == FAST_CONVERSION_ARGB8888)
+                {
+                    DWORD sum[4] = {0}, val = 0, v;
+
+                    for (k = 0; k < step_z; k++)
+                        for (j = 0; j < step_y; j++)
+                            for (i = 0; i < step_x; i++)
+                            {
+                                memcpy(&v, src_ptr + k * src_slice_pitch + j * src_row_pitch + i * 4, sizeof(v));
+                                for (c = 0; c < 4; c++)
+                                    sum[c] += (v >> (c * 8)) & 0xff;
+                            }
+
+                    for (c = 0; c < 4; c++)
+                        val |= ((sum[c] + count / 2) / count) << (c * 8);
+                    val = convert_argb8888(&fast_info, val);
+                    memcpy(dst_ptr, &val, sizeof(val));
+                }
+                else
+                {
+                    struct vec4 sum = {0.0f, 0.0f, 0.0f, 0.0f}, color, tmp;
+
+                    for (k = 0; k < step_z; k++)
+                        for (j = 0; j < step_y; j++)
+                            for (i = 0; i < step_x; i++)
+                            {
+                                format_to_vec4(src_format, src_ptr + k * src_slice_pitch + j * src_row_pitch
+                                        + i * src_format->bytes_per_pixel, &color);
+                                if (src_format->to_rgba)
+                                    src_format->to_rgba(&color, &tmp, palette);
+                                else
+                                    tmp = color;
+
+                                if (ck_format)
+                                {
+                                    DWORD ck_pixel;
+
+                                    format_from_vec4(ck_format, &tmp, (BYTE *)&ck_pixel);
+                                    if (ck_pixel == color_key)
+                                        tmp.w = 0.0f;
+                                }
+
+                                sum.x += tmp.x;
+                                sum.y += tmp.y;
+                                sum.z += tmp.z;
+                                sum.w += tmp.w;
+                            }
+
+                    tmp.x = sum.x / count;
+                    tmp.y = sum.y / count;
+                    tmp.z = sum.z / count;
+                    tmp.w = sum.w / count;
+
+                    if (dst_format->from_rgba)
+                        dst_format->from_rgba(&tmp, &color);
+                    else
+                        color = tmp;
+
+                    format_from_vec4(dst_format, &color, dst_ptr);
+                }
+
+                dst_ptr += dst_format->bytes_per_pixel;
+            }
+        }
+    }
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2110,13 +2381,19 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
             convert_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
+        else if (((filter & 0xf) == D3DX_FILTER_BOX || (filter & 0xf) == D3DX_FILTER_LINEAR)
+                && can_box_filter_argb_pixels(&src_size, &dst_size))
+        {
+            box_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
+                    dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
+        }
         else /* if ((filter & 0xf) == D3DX_FILTER_POINT) */
         {
             if ((filter & 0xf) != D3DX_FILTER_POINT)
                 FIXME("Unhandled filter %#x.\n", filter);
 
-            /* Always apply a point filter until D3DX_FILTER_LINEAR,
-             * D3DX_FILTER_TRIANGLE and D3DX_FILTER_BOX are implemented. */
+            /* Apply a point filter until D3DX_FILTER_TRIANGLE and arbitrary
+             * D3DX_FILTER_LINEAR and D3DX_FILTER_BOX scaling are implemented. */
             point_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
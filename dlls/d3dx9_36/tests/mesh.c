@@ -10546,6 +10546,171 @@ static void test_optimize_faces(void)
     ok(hr == D3DERR_INVALIDCALL, "Got unexpected hr %#x.\n", hr);
 }
 
+static void test_optimize_vertex_order(void)
+{
+    static const DWORD optimize_flags[] = {D3DXMESHOPT_VERTEXCACHE, D3DXMESHOPT_STRIPREORDER};
+    const DWORD options = D3DXMESH_32BIT | D3DXMESH_SYSTEMMEM;
+    const D3DVERTEXELEMENT9 declaration[] =
+    {
+        {0, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0},
+        D3DDECL_END()
+    };
+    /* 3x2 grid of quads, two triangles per quad
+     *
+     * 0--1--2--3
+     * | /| /| /|
+     * |/ |/ |/ |
+     * 4--5--6--7
+     * | /| /| /|
+     * |/ |/ |/ |
+     * 8--9-10-11
+     */
+    const D3DXVECTOR3 vertices[] =
+    {
+        {0.0f, 2.0f, 0.0f}, {1.0f, 2.0f, 0.0f}, {2.0f, 2.0f, 0.0f}, {3.0f, 2.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {2.0f, 1.0f, 0.0f}, {3.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {3.0f, 0.0f, 0.0f},
+    };
+    const DWORD indices[] =
+    {
+        0, 1, 4,   1, 5, 4,   1, 2, 5,   2, 6, 5,   2, 3, 6,   3, 7, 6,
+        4, 5, 8,   5, 9, 8,   5, 6, 9,   6, 10, 9,  6, 7, 10,  7, 11, 10,
+    };
+    const DWORD attributes[] = {1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0};
+    const unsigned int num_vertices = ARRAY_SIZE(vertices);
+    D3DXVECTOR3 extra_vertices[ARRAY_SIZE(vertices) + 1];
+    const unsigned int num_faces = ARRAY_SIZE(indices) / 3;
+    DWORD adjacency[ARRAY_SIZE(indices)], adjacency_out[ARRAY_SIZE(indices)];
+    DWORD face_remap[ARRAY_SIZE(indices) / 3];
+    struct test_context *test_context;
+    ID3DXBuffer *vertex_remap;
+    DWORD *new_indices, *new_attributes, *vertex_remap_ptr;
+    D3DXVECTOR3 *new_vertices;
+    ID3DXMesh *mesh = NULL;
+    unsigned int i, j, k;
+    BOOL used[ARRAY_SIZE(indices) / 3], used_vertices[ARRAY_SIZE(vertices)];
+    HRESULT hr;
+
+    test_context = new_test_context();
+    if (!test_context)
+    {
+        skip("Couldn't create test context\n");
+        return;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(optimize_flags); i++)
+    {
+        hr = init_test_mesh(num_faces, num_vertices, options, declaration, test_context->device, &mesh,
+                vertices, sizeof(*vertices), indices, attributes);
+        if (FAILED(hr))
+        {
+            skip("Couldn't initialize test mesh, hr %#x.\n", hr);
+            break;
+        }
+
+        hr = mesh->lpVtbl->GenerateAdjacency(mesh, 0.0f, adjacency);
+        ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, optimize_flags[i], NULL, NULL, NULL, NULL);
+        ok(hr == D3DERR_INVALIDCALL, "Flags %#x, got unexpected hr %#x.\n", optimize_flags[i], hr);
+
+        vertex_remap = NULL;
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, optimize_flags[i], adjacency, adjacency_out,
+                face_remap, &vertex_remap);
+        ok(hr == D3D_OK, "Flags %#x, got unexpected hr %#x.\n", optimize_flags[i], hr);
+        ok(mesh->lpVtbl->GetNumFaces(mesh) == num_faces, "Flags %#x, got %u faces.\n",
+                optimize_flags[i], mesh->lpVtbl->GetNumFaces(mesh));
+        ok(mesh->lpVtbl->GetNumVertices(mesh) == num_vertices, "Flags %#x, got %u vertices.\n",
+                optimize_flags[i], mesh->lpVtbl->GetNumVertices(mesh));
+        ok(!!vertex_remap, "Flags %#x, got NULL vertex remap.\n", optimize_flags[i]);
+
+        mesh->lpVtbl->LockVertexBuffer(mesh, D3DLOCK_READONLY, (void **)&new_vertices);
+        mesh->lpVtbl->LockIndexBuffer(mesh, D3DLOCK_READONLY, (void **)&new_indices);
+        mesh->lpVtbl->LockAttributeBuffer(mesh, D3DLOCK_READONLY, &new_attributes);
+        vertex_remap_ptr = vertex_remap ? ID3DXBuffer_GetBufferPointer(vertex_remap) : NULL;
+
+        /* The faces are the same, in a different order, and sorted by attribute. */
+        memset(used, 0, sizeof(used));
+        for (j = 0; j < num_faces; j++)
+        {
+            DWORD old_face = face_remap[j];
+
+            ok(old_face < num_faces && !used[old_face], "Flags %#x, got face remap %u for face %u.\n",
+                    optimize_flags[i], old_face, j);
+            if (old_face >= num_faces || used[old_face])
+                continue;
+            used[old_face] = TRUE;
+
+            ok(new_attributes[j] == attributes[old_face], "Flags %#x, got attribute %u for face %u.\n",
+                    optimize_flags[i], new_attributes[j], j);
+            if (j)
+                ok(new_attributes[j] >= new_attributes[j - 1], "Flags %#x, faces are not sorted by attribute.\n",
+                        optimize_flags[i]);
+
+            for (k = 0; k < 3; k++)
+            {
+                const D3DXVECTOR3 *v = &new_vertices[new_indices[j * 3 + k]];
+                const D3DXVECTOR3 *expected = &vertices[indices[old_face * 3 + k]];
+
+                ok(!memcmp(v, expected, sizeof(*v)), "Flags %#x, face %u, vertex %u doesn't match.\n",
+                        optimize_flags[i], j, k);
+                if (vertex_remap_ptr)
+                    ok(vertex_remap_ptr[new_indices[j * 3 + k]] == indices[old_face * 3 + k],
+                            "Flags %#x, face %u, got unexpected vertex remap.\n", optimize_flags[i], j);
+            }
+        }
+
+        mesh->lpVtbl->UnlockAttributeBuffer(mesh);
+        mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        mesh->lpVtbl->UnlockVertexBuffer(mesh);
+        if (vertex_remap)
+            ID3DXBuffer_Release(vertex_remap);
+        mesh->lpVtbl->Release(mesh);
+        mesh = NULL;
+    }
+
+    /* D3DXMESHOPT_COMPACT drops the unreferenced vertex. */
+    memcpy(extra_vertices, vertices, sizeof(vertices));
+    extra_vertices[num_vertices].x = extra_vertices[num_vertices].y = extra_vertices[num_vertices].z = 5.0f;
+    hr = init_test_mesh(num_faces, num_vertices + 1, options, declaration, test_context->device, &mesh,
+            extra_vertices, sizeof(*extra_vertices), indices, attributes);
+    if (FAILED(hr))
+    {
+        skip("Couldn't initialize test mesh, hr %#x.\n", hr);
+        free_test_context(test_context);
+        return;
+    }
+
+    hr = mesh->lpVtbl->GenerateAdjacency(mesh, 0.0f, adjacency);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    vertex_remap = NULL;
+    hr = mesh->lpVtbl->OptimizeInplace(mesh, D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_COMPACT, adjacency,
+            adjacency_out, face_remap, &vertex_remap);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    ok(mesh->lpVtbl->GetNumVertices(mesh) == num_vertices, "Got %u vertices.\n",
+            mesh->lpVtbl->GetNumVertices(mesh));
+    ok(!!vertex_remap, "Got NULL vertex remap.\n");
+    if (vertex_remap)
+    {
+        vertex_remap_ptr = ID3DXBuffer_GetBufferPointer(vertex_remap);
+        memset(used_vertices, 0, sizeof(used_vertices));
+        for (j = 0; j < num_vertices; j++)
+        {
+            ok(vertex_remap_ptr[j] < num_vertices && !used_vertices[vertex_remap_ptr[j]],
+                    "Got vertex remap %u for vertex %u.\n", vertex_remap_ptr[j], j);
+            if (vertex_remap_ptr[j] < num_vertices)
+                used_vertices[vertex_remap_ptr[j]] = TRUE;
+        }
+        ok(vertex_remap_ptr[num_vertices] == ~0u, "Got vertex remap %#x for the unused vertex.\n",
+                vertex_remap_ptr[num_vertices]);
+        ID3DXBuffer_Release(vertex_remap);
+    }
+    mesh->lpVtbl->Release(mesh);
+
+    free_test_context(test_context);
+}
+
 static HRESULT clear_normals(ID3DXMesh *mesh)
 {
     HRESULT hr;
@@ -11484,6 +11649,7 @@ START_TEST(mesh)
     test_clone_mesh();
     test_valid_mesh();
     test_optimize_faces();
+    test_optimize_vertex_order();
     test_compute_normals();
     test_D3DXFrameFind();
     test_load_skin_mesh_from_xof();
@@ -847,6 +847,7 @@ static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
     static const DWORD pixdata_g16r16[] = { 0x07d23fbe, 0xdc7f44a4, 0xe4d8976b, 0x9a84fe89 };
     static const DWORD pixdata_a8b8g8r8[] = { 0xc3394cf0, 0x235ae892, 0x09b197fd, 0x8dc32bf6 };
     static const DWORD pixdata_a2r10g10b10[] = { 0x57395aff, 0x5b7668fd, 0xb0d856b5, 0xff2c61d6 };
+    static const DWORD pixdata_box[] = { 0x10203040, 0x30405060, 0x50607080, 0x708090a0 };
 
     hr = create_file("testdummy.bmp", noimage, sizeof(noimage));  /* invalid image */
     testdummy_ok = SUCCEEDED(hr);
@@ -1082,6 +1083,21 @@ static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
     IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
     check_pixel_4bpp(&lockrect, 0, 0, 0x8dc32bf6);
     IDirect3DSurface9_UnlockRect(surf);
+
+    /* box filter, 2:1 reduction */
+    SetRect(&rect, 0, 0, 2, 2);
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_box,
+            D3DFMT_A8R8G8B8, 8, NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp(&lockrect, 0, 0, 0x40506070);
+    IDirect3DSurface9_UnlockRect(surf);
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_box,
+            D3DFMT_A8B8G8R8, 8, NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp(&lockrect, 0, 0, 0x40706050);
+    IDirect3DSurface9_UnlockRect(surf);
     check_release((IUnknown *)surf, 0);
 
     /* test color conversion */
@@ -0,0 +1,243 @@
+/*
+ * DNS resolver cache
+ *
+ * Copyright (C) the Wine project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+
+#include "windef.h"
+#include "winbase.h"
+#include "winerror.h"
+#include "winnls.h"
+#include "windns.h"
+
+#include "wine/debug.h"
+#include "wine/list.h"
+#include "dnsapi.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(dnsapi);
+
+#define CACHE_HASH_SIZE     64
+#define CACHE_MAX_ENTRIES   512
+#define CACHE_MAX_TTL       86400 /* seconds */
+#define CACHE_NEGATIVE_TTL  300
+
+struct cache_entry
+{
+    struct list  entry;      /* entry in the hash bucket */
+    struct list  lru_entry;  /* entry in the lru list, most recently used first */
+    char        *name;       /* lower case, without trailing dots */
+    WORD         type;
+    DNS_STATUS   status;
+    DNS_RECORDA *records;    /* UTF-8 records for successful lookups */
+    ULONGLONG    added;      /* tick count in ms */
+    ULONGLONG    expires;
+};
+
+static struct list cache_hash[CACHE_HASH_SIZE];
+static struct list cache_lru = LIST_INIT( cache_lru );
+static unsigned int cache_count;
+
+static CRITICAL_SECTION cache_cs;
+static CRITICAL_SECTION_DEBUG cache_cs_debug =
+{
+    0, 0, &cache_cs,
+    { &cache_cs_debug.ProcessLocksList, &cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": cache_cs") }
+};
+static CRITICAL_SECTION cache_cs = { &cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static BOOL normalize_name( const char *name, char *buf, unsigned int *hash )
+{
+    unsigned int len = strlen( name ), i;
+
+    while (len && name[len - 1] == '.') len--;
+    if (!len || len >= DNS_MAX_NAME_BUFFER_LENGTH) return FALSE;
+
+    *hash = 0;
+    for (i = 0; i < len; i++)
+    {
+        buf[i] = (name[i] >= 'A' && name[i] <= 'Z') ? name[i] + 'a' - 'A' : name[i];
+        *hash = *hash * 31 + (unsigned char)buf[i];
+    }
+    buf[len] = 0;
+    return TRUE;
+}
+
+static struct list *get_bucket( unsigned int hash )
+{
+    struct list *bucket = &cache_hash[hash % CACHE_HASH_SIZE];
+
+    if (!bucket->next) list_init( bucket );
+    return bucket;
+}
+
+static void free_entry( struct cache_entry *entry )
+{
+    list_remove( &entry->entry );
+    list_remove( &entry->lru_entry );
+    DnsRecordListFree( (DNS_RECORD *)entry->records, DnsFreeRecordList );
+    heap_free( entry->name );
+    heap_free( entry );
+    cache_count--;
+}
+
+static struct cache_entry *find_entry( struct list *bucket, const char *name, WORD type )
+{
+    struct cache_entry *entry;
+
+    LIST_FOR_EACH_ENTRY( entry, bucket, struct cache_entry, entry )
+    {
+        if (entry->type == type && !strcmp( entry->name, name )) return entry;
+    }
+    return NULL;
+}
+
+static DWORD get_min_ttl( const DNS_RECORDA *records )
+{
+    DWORD ttl = CACHE_MAX_TTL;
+    const DNS_RECORDA *r;
+
+    for (r = records; r; r = r->pNext)
+    {
+        if (r->Flags.S.Section == DnsSectionAnswer && r->dwTtl < ttl) ttl = r->dwTtl;
+    }
+    return ttl;
+}
+
+/* returns TRUE and fills in the result if the query is answered from the cache */
+BOOL cache_lookup( const char *name, WORD type, DWORD options, DNS_STATUS *status, DNS_RECORDA **result )
+{
+    char key[DNS_MAX_NAME_BUFFER_LENGTH];
+    struct cache_entry *entry;
+    unsigned int hash;
+    ULONGLONG now;
+    BOOL ret = FALSE;
+
+    if (!normalize_name( name, key, &hash )) return FALSE;
+
+    EnterCriticalSection( &cache_cs );
+
+    now = GetTickCount64();
+    if ((entry = find_entry( get_bucket( hash ), key, type )))
+    {
+        if (entry->expires <= now)
+        {
+            TRACE( "expired %s %s\n", debugstr_a(key), type_to_str( type ) );
+            free_entry( entry );
+        }
+        else if ((*status = entry->status))
+        {
+            list_remove( &entry->lru_entry );
+            list_add_head( &cache_lru, &entry->lru_entry );
+            ret = TRUE;
+        }
+        else if ((*result = (DNS_RECORDA *)DnsRecordSetCopyEx( (DNS_RECORD *)entry->records,
+                                                                DnsCharSetUtf8, DnsCharSetUtf8 )))
+        {
+            DWORD elapsed = (now - entry->added) / 1000;
+            DNS_RECORDA *r;
+
+            if (!(options & DNS_QUERY_DONT_RESET_TTL_VALUES))
+            {
+                for (r = *result; r; r = r->pNext)
+                    r->dwTtl = r->dwTtl > elapsed ? r->dwTtl - elapsed : 0;
+            }
+            list_remove( &entry->lru_entry );
+            list_add_head( &cache_lru, &entry->lru_entry );
+            ret = TRUE;
+        }
+    }
+
+    LeaveCriticalSection( &cache_cs );
+
+    if (ret) TRACE( "cache hit for %s %s, status %d\n", debugstr_a(name), type_to_str( type ), *status );
+    return ret;
+}
+
+/* records the result of a wire query, name errors and empty answers are cached too */
+void cache_insert( const char *name, WORD type, DNS_STATUS status, const DNS_RECORDA *records )
+{
+    char key[DNS_MAX_NAME_BUFFER_LENGTH];
+    struct cache_entry *entry, *old;
+    struct list *bucket;
+    unsigned int hash;
+    DWORD ttl;
+
+    if (status == ERROR_SUCCESS) ttl = get_min_ttl( records );
+    else if (status == DNS_ERROR_RCODE_NAME_ERROR || status == DNS_INFO_NO_RECORDS) ttl = CACHE_NEGATIVE_TTL;
+    else return;
+
+    if (!ttl || !normalize_name( name, key, &hash )) return;
+
+    if (!(entry = heap_alloc_zero( sizeof(*entry) ))) return;
+    if (!(entry->name = strdup_u( key )) ||
+        (!status && !(entry->records = (DNS_RECORDA *)DnsRecordSetCopyEx( (DNS_RECORD *)records,
+                                                                         DnsCharSetUtf8, DnsCharSetUtf8 ))))
+    {
+        heap_free( entry->name );
+        heap_free( entry );
+        return;
+    }
+    entry->type    = type;
+    entry->status  = status;
+    entry->added   = GetTickCount64();
+    entry->expires = entry->added + (ULONGLONG)ttl * 1000;
+
+    EnterCriticalSection( &cache_cs );
+
+    bucket = get_bucket( hash );
+    if ((old = find_entry( bucket, key, type ))) free_entry( old );
+    else if (cache_count >= CACHE_MAX_ENTRIES)
+        free_entry( LIST_ENTRY( list_tail( &cache_lru ), struct cache_entry, lru_entry ) );
+
+    list_add_head( bucket, &entry->entry );
+    list_add_head( &cache_lru, &entry->lru_entry );
+    cache_count++;
+
+    LeaveCriticalSection( &cache_cs );
+
+    TRACE( "cached %s %s, status %d, ttl %u\n", debugstr_a(key), type_to_str( type ), status, ttl );
+}
+
+/* flushes the entries for the given name, or the whole cache if name is NULL */
+void cache_flush( const char *name )
+{
+    char key[DNS_MAX_NAME_BUFFER_LENGTH];
+    struct cache_entry *entry, *next;
+    unsigned int hash;
+
+    if (name && !normalize_name( name, key, &hash )) return;
+
+    EnterCriticalSection( &cache_cs );
+
+    if (!name)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE( entry, next, &cache_lru, struct cache_entry, lru_entry )
+            free_entry( entry );
+    }
+    else
+    {
+        struct list *bucket = get_bucket( hash );
+
+        LIST_FOR_EACH_ENTRY_SAFE( entry, next, bucket, struct cache_entry, entry )
+            if (!strcmp( entry->name, key )) free_entry( entry );
+    }
+
+    LeaveCriticalSection( &cache_cs );
+}
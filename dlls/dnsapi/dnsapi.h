@@ -121,6 +121,10 @@ static inline char *strdup_ua( const char *src )
 
 extern const char *type_to_str( unsigned short ) DECLSPEC_HIDDEN;
 
+extern BOOL cache_lookup( const char *, WORD, DWORD, DNS_STATUS *, DNS_RECORDA ** ) DECLSPEC_HIDDEN;
+extern void cache_insert( const char *, WORD, DNS_STATUS, const DNS_RECORDA * ) DECLSPEC_HIDDEN;
+extern void cache_flush( const char * ) DECLSPEC_HIDDEN;
+
 struct resolv_funcs
 {
     DNS_STATUS (CDECL *get_searchlist)( DNS_TXT_DATAW *list, DWORD *len );
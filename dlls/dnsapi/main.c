@@ -25,9 +25,11 @@
 #include "winternl.h"
 #include "winbase.h"
 #include "winerror.h"
+#include "winnls.h"
 #include "windns.h"
 
 #include "wine/debug.h"
+#include "dnsapi.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dnsapi);
 
@@ -95,7 +97,8 @@ DNS_STATUS WINAPI DnsAcquireContextHandle_W( DWORD flags, PVOID cred,
  */
 VOID WINAPI DnsFlushResolverCache(void)
 {
-    FIXME(": stub\n");
+    TRACE( "\n" );
+    cache_flush( NULL );
 }
 
 /******************************************************************************
@@ -104,8 +107,14 @@ VOID WINAPI DnsFlushResolverCache(void)
  */
 BOOL WINAPI DnsFlushResolverCacheEntry_A( PCSTR entry )
 {
-    FIXME( "%s: stub\n", debugstr_a(entry) );
+    char *entryU;
+
+    TRACE( "%s\n", debugstr_a(entry) );
+
     if (!entry) return FALSE;
+    if (!(entryU = strdup_au( entry ))) return FALSE;
+    cache_flush( entryU );
+    heap_free( entryU );
     return TRUE;
 }
 
@@ -115,8 +124,10 @@ BOOL WINAPI DnsFlushResolverCacheEntry_A( PCSTR entry )
  */
 BOOL WINAPI DnsFlushResolverCacheEntry_UTF8( PCSTR entry )
 {
-    FIXME( "%s: stub\n", debugstr_a(entry) );
+    TRACE( "%s\n", debugstr_a(entry) );
+
     if (!entry) return FALSE;
+    cache_flush( entry );
     return TRUE;
 }
 
@@ -126,8 +137,14 @@ BOOL WINAPI DnsFlushResolverCacheEntry_UTF8( PCSTR entry )
  */
 BOOL WINAPI DnsFlushResolverCacheEntry_W( PCWSTR entry )
 {
-    FIXME( "%s: stub\n", debugstr_w(entry) );
+    char *entryU;
+
+    TRACE( "%s\n", debugstr_w(entry) );
+
     if (!entry) return FALSE;
+    if (!(entryU = strdup_wu( entry ))) return FALSE;
+    cache_flush( entryU );
+    heap_free( entryU );
     return TRUE;
 }
 
@@ -34,6 +34,11 @@ WINE_DEFAULT_DEBUG_CHANNEL(dnsapi);
 
 #define DEFAULT_TTL  1200
 
+/* options that bypass the resolver cache or change the answer of a query */
+#define NO_CACHE_OPTIONS (DNS_QUERY_BYPASS_CACHE | DNS_QUERY_WIRE_ONLY | DNS_QUERY_NO_RECURSION | \
+                          DNS_QUERY_NO_LOCAL_NAME | DNS_QUERY_NO_HOSTS_FILE | DNS_QUERY_TREAT_AS_FQDN | \
+                          DNS_QUERY_RETURN_MESSAGE)
+
 static DNS_STATUS do_query_netbios( PCSTR name, DNS_RECORDA **recp )
 {
     NCB ncb;
@@ -168,6 +173,7 @@ DNS_STATUS WINAPI DnsQuery_UTF8( PCSTR name, WORD type, DWORD options, PVOID ser
                                  PDNS_RECORDA *result, PVOID *reserved )
 {
     DNS_STATUS ret = DNS_ERROR_RCODE_NOT_IMPLEMENTED;
+    BOOL use_cache;
 
     TRACE( "(%s,%s,0x%08x,%p,%p,%p)\n", debugstr_a(name), type_to_str( type ),
            options, servers, result, reserved );
@@ -175,9 +181,19 @@ DNS_STATUS WINAPI DnsQuery_UTF8( PCSTR name, WORD type, DWORD options, PVOID ser
     if (!name || !result)
         return ERROR_INVALID_PARAMETER;
 
-    if ((ret = resolv_funcs->set_serverlist( servers ))) return ret;
+    use_cache = !servers && !(options & NO_CACHE_OPTIONS);
+    if (!use_cache || !cache_lookup( name, type, options, &ret, result ))
+    {
+        if (options & DNS_QUERY_NO_WIRE_QUERY)
+        {
+            TRACE( "not in the cache\n" );
+            return DNS_ERROR_RECORD_DOES_NOT_EXIST;
+        }
+        if ((ret = resolv_funcs->set_serverlist( servers ))) return ret;
 
-    ret = resolv_funcs->query( name, type, options, result );
+        ret = resolv_funcs->query( name, type, options, result );
+        if (use_cache) cache_insert( name, type, ret, ret ? NULL : *result );
+    }
 
     if (ret == DNS_ERROR_RCODE_NAME_ERROR && type == DNS_TYPE_A &&
         !(options & DNS_QUERY_NO_NETBT))
@@ -28,6 +28,9 @@
 
 #include "wine/test.h"
 
+VOID WINAPI DnsFlushResolverCache(void);
+BOOL WINAPI DnsFlushResolverCacheEntry_A(PCSTR);
+
 static void test_DnsGetCacheDataTable( void )
 {
     BOOL ret;
@@ -43,7 +46,59 @@ static void test_DnsGetCacheDataTable( void )
     ok( entry != NULL, "DnsGetCacheDataTable returned NULL\n" );
 }
 
+static void test_cached_query( void )
+{
+    DNS_RECORDA *rec;
+    DNS_STATUS status;
+    BOOL ret;
+
+    rec = NULL;
+    status = DnsQuery_A( "winehq.org", DNS_TYPE_A, DNS_QUERY_STANDARD, NULL, &rec, NULL );
+    if (status)
+    {
+        skip( "query failed, status %d\n", status );
+        return;
+    }
+    ok( rec != NULL, "got NULL records\n" );
+    DnsRecordListFree( (DNS_RECORD *)rec, DnsFreeRecordList );
+
+    /* the answer must now come from the cache, without a wire query */
+    rec = NULL;
+    status = DnsQuery_A( "WineHQ.org.", DNS_TYPE_A, DNS_QUERY_NO_WIRE_QUERY, NULL, &rec, NULL );
+    ok( !status, "got %d\n", status );
+    if (!status)
+    {
+        ok( rec != NULL, "got NULL records\n" );
+        ok( rec->wType == DNS_TYPE_A, "got type %u\n", rec->wType );
+        DnsRecordListFree( (DNS_RECORD *)rec, DnsFreeRecordList );
+    }
+
+    ret = DnsFlushResolverCacheEntry_A( "winehq.org" );
+    ok( ret, "got %d\n", ret );
+
+    rec = (DNS_RECORDA *)0xdeadbeef;
+    status = DnsQuery_A( "winehq.org", DNS_TYPE_A, DNS_QUERY_NO_WIRE_QUERY, NULL, &rec, NULL );
+    ok( status, "entry was not flushed\n" );
+    if (!status) DnsRecordListFree( (DNS_RECORD *)rec, DnsFreeRecordList );
+
+    status = DnsQuery_A( "winehq.org", DNS_TYPE_A, DNS_QUERY_STANDARD, NULL, &rec, NULL );
+    if (status)
+    {
+        skip( "second query failed, status %d\n", status );
+        return;
+    }
+    DnsRecordListFree( (DNS_RECORD *)rec, DnsFreeRecordList );
+
+    DnsFlushResolverCache();
+
+    rec = (DNS_RECORDA *)0xdeadbeef;
+    status = DnsQuery_A( "winehq.org", DNS_TYPE_A, DNS_QUERY_NO_WIRE_QUERY, NULL, &rec, NULL );
+    ok( status, "cache was not flushed\n" );
+    if (!status) DnsRecordListFree( (DNS_RECORD *)rec, DnsFreeRecordList );
+}
+
 START_TEST(cache)
 {
     test_DnsGetCacheDataTable();
+    test_cached_query();
 }
@@ -111,6 +111,62 @@ float get_mono(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel)
     return val;
 }
 
+static void get8_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign, i;
+    const BYTE *buf = base + channel;
+
+    for (i = 0; i < count; i++, buf += stride)
+        out[i] = (buf[0] - 0x80) / (float)0x80;
+}
+
+static void get16_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign, i;
+    const BYTE *buf = base + 2 * channel;
+
+    for (i = 0; i < count; i++, buf += stride)
+        out[i] = (SHORT)le16(*(const SHORT *)buf) / (float)0x8000;
+}
+
+static void get24_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign, i;
+    const BYTE *buf = base + 3 * channel;
+
+    for (i = 0; i < count; i++, buf += stride)
+        out[i] = (LONG)((buf[0] << 8) | (buf[1] << 16) | (buf[2] << 24)) / (float)0x80000000U;
+}
+
+static void get32_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign, i;
+    const BYTE *buf = base + 4 * channel;
+
+    for (i = 0; i < count; i++, buf += stride)
+        out[i] = (LONG)le32(*(const LONG *)buf) / (float)0x80000000U;
+}
+
+static void getieee32_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign, i;
+    const BYTE *buf = base + 4 * channel;
+
+    for (i = 0; i < count; i++, buf += stride)
+        out[i] = *(const float *)buf;
+}
+
+const bitsgetblockfunc getblockbpp[5] = {get8_block, get16_block, get24_block, get32_block, getieee32_block};
+
+/* used when the samples need more than a format conversion, e.g. downmixing */
+void get_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count)
+{
+    UINT stride = dsb->pwfx->nBlockAlign, i;
+
+    for (i = 0; i < count; i++, base += stride)
+        out[i] = dsb->get(dsb, base, channel);
+}
+
 static inline unsigned char f_to_8(float value)
 {
     if(value <= -1.f)
@@ -44,8 +44,11 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 
 /* dsound_convert.h */
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, BYTE *, DWORD);
+typedef void (*bitsgetblockfunc)(const IDirectSoundBufferImpl *, BYTE *, DWORD, float *, UINT);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
 extern const bitsgetfunc getbpp[5] DECLSPEC_HIDDEN;
+extern const bitsgetblockfunc getblockbpp[5] DECLSPEC_HIDDEN;
+void get_block(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel, float *out, UINT count) DECLSPEC_HIDDEN;
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void mixieee32(float *src, float *dst, unsigned samples) DECLSPEC_HIDDEN;
@@ -169,6 +172,7 @@ struct IDirectSoundBufferImpl
     /* Used for bit depth conversion */
     int                         mix_channels;
     bitsgetfunc get, get_aux;
+    bitsgetblockfunc get_block;
     bitsputfunc put, put_aux;
     int                         num_filters;
     DSFilter*                   filters;
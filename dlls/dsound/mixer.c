@@ -136,6 +136,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	dsb->put_aux = putieee32;
 
 	dsb->get = dsb->get_aux;
+	dsb->get_block = ieee ? getblockbpp[4] : getblockbpp[dsb->pwfx->wBitsPerSample/8 - 1];
 	dsb->put = dsb->put_aux;
 
 	if (ichannels == ochannels)
@@ -161,6 +162,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	{
 		dsb->mix_channels = 1;
 		dsb->get = get_mono;
+		dsb->get_block = get_block;
 	}
 	else if (ichannels == 2 && ochannels == 4)
 	{
@@ -275,35 +277,93 @@ void DSOUND_CheckEvent(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len
     }
 }
 
-static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
-        BYTE *buffer, DWORD buflen, DWORD mixpos, DWORD channel)
+/**
+ * Convert count frames of one channel, starting at byte offset mixpos of the
+ * given buffer, to float. Looping buffers wrap around, others are padded with
+ * silence past their end.
+ */
+static void get_current_samples(const IDirectSoundBufferImpl *dsb, BYTE *buffer, DWORD buflen,
+        DWORD mixpos, DWORD channel, float *out, UINT count)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT len;
+
+    while (count)
+    {
+        if (mixpos >= buflen)
+        {
+            if (!(dsb->playflags & DSBPLAY_LOOPING))
+            {
+                memset(out, 0, count * sizeof(float));
+                return;
+            }
+            mixpos %= buflen;
+        }
+
+        if (!(len = min(count, (buflen - mixpos) / istride))) len = 1;
+        dsb->get_block(dsb, buffer + mixpos, channel, out, len);
+        out += len;
+        count -= len;
+        mixpos += len * istride;
+    }
+}
+
+/**
+ * Store count frames of one channel, scaled by gain, in the temporary buffer.
+ * Without a channel conversion the samples are written directly.
+ */
+static void put_samples(const IDirectSoundBufferImpl *dsb, DWORD channel, const float *in, UINT count, float gain)
 {
-    if (mixpos >= buflen && !(dsb->playflags & DSBPLAY_LOOPING))
-        return 0.0f;
-    return dsb->get(dsb, buffer + (mixpos % buflen), channel);
+    UINT ochannels = dsb->device->pwfx->nChannels;
+    float *out = dsb->device->tmp_buffer + channel;
+    UINT i;
+
+    if (dsb->put == putieee32)
+    {
+        for (i = 0; i < count; i++)
+            out[i * ochannels] = in[i] * gain;
+    }
+    else
+    {
+        for (i = 0; i < count; i++)
+            dsb->put(dsb, i * ochannels * sizeof(float), channel, in[i] * gain);
+    }
+}
+
+static float *get_cp_buffer(DirectSoundDevice *device, DWORD len)
+{
+    if (!device->cp_buffer) {
+        device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
+        device->cp_buffer_len = len;
+    } else if (len > device->cp_buffer_len) {
+        device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, device->cp_buffer, len);
+        device->cp_buffer_len = len;
+    }
+    return device->cp_buffer;
 }
 
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
-    UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
     UINT committed_samples = 0;
-    DWORD channel, i;
+    DWORD channel;
+    float *samples;
 
     if(dsb->use_committed) {
         committed_samples = (dsb->writelead - dsb->committed_mixpos) / istride;
         committed_samples = committed_samples <= count ? committed_samples : count;
     }
 
-    for (i = 0; i < committed_samples; i++)
-        for (channel = 0; channel < dsb->mix_channels; channel++)
-            dsb->put(dsb, i * ostride, channel, get_current_sample(dsb, dsb->committedbuff,
-                dsb->writelead, dsb->committed_mixpos + i * istride, channel));
+    samples = get_cp_buffer(dsb->device, count * sizeof(float));
 
-    for (; i < count; i++)
-        for (channel = 0; channel < dsb->mix_channels; channel++)
-            dsb->put(dsb, i * ostride, channel, get_current_sample(dsb, dsb->buffer->memory,
-                dsb->buflen, dsb->sec_mixpos + i * istride, channel));
+    for (channel = 0; channel < dsb->mix_channels; channel++) {
+        get_current_samples(dsb, dsb->committedbuff, dsb->writelead,
+                dsb->committed_mixpos, channel, samples, committed_samples);
+        get_current_samples(dsb, dsb->buffer->memory, dsb->buflen,
+                dsb->sec_mixpos + committed_samples * istride, channel,
+                samples + committed_samples, count - committed_samples);
+        put_samples(dsb, channel, samples, count, 1.0f);
+    }
 
     return count;
 }
@@ -312,7 +372,8 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
 {
     UINT i, channel;
     UINT istride = dsb->pwfx->nBlockAlign;
-    UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
+    UINT ochannels = dsb->device->pwfx->nChannels;
+    UINT ostride = ochannels * sizeof(float);
     UINT committed_samples = 0;
 
     LONG64 freqAcc_start = *freqAccNum;
@@ -320,24 +381,18 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
     UINT dsbfirstep = dsb->firstep;
     UINT channels = dsb->mix_channels;
     UINT max_ipos = (freqAcc_start + count * dsb->freqAdjustNum) / dsb->freqAdjustDen;
+    BOOL direct = dsb->put == putieee32;
+    float *out = dsb->device->tmp_buffer;
 
     UINT fir_cachesize = (fir_len + dsbfirstep - 2) / dsbfirstep;
     UINT required_input = max_ipos + fir_cachesize;
-    float *intermediate, *fir_copy, *itmp;
+    float *intermediate, *fir_copy;
 
     DWORD len = required_input * channels;
     len += fir_cachesize;
     len *= sizeof(float);
 
-    if (!dsb->device->cp_buffer) {
-        dsb->device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
-        dsb->device->cp_buffer_len = len;
-    } else if (len > dsb->device->cp_buffer_len) {
-        dsb->device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->device->cp_buffer, len);
-        dsb->device->cp_buffer_len = len;
-    }
-
-    fir_copy = dsb->device->cp_buffer;
+    fir_copy = get_cp_buffer(dsb->device, len);
     intermediate = fir_copy + fir_cachesize;
 
     if(dsb->use_committed) {
@@ -349,14 +404,14 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
      * if you want -msse3 to have any effect.
      * This is good for CPU cache effects, too.
      */
-    itmp = intermediate;
     for (channel = 0; channel < channels; channel++) {
-        for (i = 0; i < committed_samples; i++)
-            *(itmp++) = get_current_sample(dsb, dsb->committedbuff,
-                dsb->writelead, dsb->committed_mixpos + i * istride, channel);
-        for (; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb, dsb->buffer->memory,
-                    dsb->buflen, dsb->sec_mixpos + i * istride, channel);
+        float *itmp = intermediate + channel * required_input;
+
+        get_current_samples(dsb, dsb->committedbuff, dsb->writelead,
+                dsb->committed_mixpos, channel, itmp, committed_samples);
+        get_current_samples(dsb, dsb->buffer->memory, dsb->buflen,
+                dsb->sec_mixpos + committed_samples * istride, channel,
+                itmp + committed_samples, required_input - committed_samples);
     }
 
     for(i = 0; i < count; ++i) {
@@ -382,7 +437,10 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
             float* cache = &intermediate[channel * required_input + ipos];
             for (j = 0; j < fir_used; j++)
                 sum += fir_copy[j] * cache[j];
-            dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
+            if (direct)
+                out[i * ochannels + channel] = sum * dsb->firgain;
+            else
+                dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
     }
 
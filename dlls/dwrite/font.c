@@ -624,6 +624,7 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
             heap_free(fontface->cached);
         }
         release_scriptshaping_cache(fontface->shaping_cache);
+        release_shaped_run_cache(fontface->shaped_runs);
         if (fontface->vdmx.context)
             IDWriteFontFace5_ReleaseFontTable(iface, fontface->vdmx.context);
         if (fontface->gasp.context)
@@ -1128,7 +1128,6 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     unsigned int max_count;
     HRESULT hr;
 
-    run->descr.localeName = get_layout_range_by_pos(layout, run->descr.textPosition)->locale;
     run->clustermap = heap_calloc(run->descr.stringLength, sizeof(*run->clustermap));
     if (!run->clustermap)
         return E_OUTOFMEMORY;
@@ -1143,9 +1142,6 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     if (!context->text_props || !context->glyph_props)
         return E_OUTOFMEMORY;
 
-    if (FAILED(hr = layout_shape_get_user_features(layout, context)))
-        return hr;
-
     for (;;)
     {
         hr = IDWriteTextAnalyzer2_GetGlyphs(context->analyzer, run->descr.string, run->descr.stringLength, run->run.fontFace,
@@ -1291,25 +1287,328 @@ static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, stru
         WARN("%s: failed to get glyph placement info, hr %#x.\n", debugstr_rundescr(&run->descr), hr);
     }
 
-    if (SUCCEEDED(hr))
-        hr = layout_shape_apply_character_spacing(layout, context);
-
     run->run.glyphAdvances = run->advances;
     run->run.glyphOffsets = run->offsets;
 
     return hr;
 }
 
+/* Shaping results are cached per font face, which makes them available to every layout created
+   from the same factory. Layouts are commonly recreated for the same strings. */
+
+#define SHAPED_RUN_CACHE_SIZE 64
+#define SHAPED_RUN_MAX_LENGTH 1024
+
+struct shaped_run_key
+{
+    const WCHAR *string;
+    UINT32 length;
+    const WCHAR *locale;
+    float emsize;
+    DWRITE_SCRIPT_ANALYSIS sa;
+    BOOL is_sideways;
+    BOOL is_rtl;
+    BOOL gdi_compatible;
+    BOOL gdi_natural;
+    float ppdip;
+    DWRITE_MATRIX transform;
+    UINT32 *features;
+    UINT32 features_count;
+    UINT32 hash;
+};
+
+struct shaped_run
+{
+    struct list entry;
+    struct shaped_run_key key;
+    UINT32 glyph_count;
+    UINT16 *glyphs;
+    UINT16 *clustermap;
+    DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
+    float *advances;
+    DWRITE_GLYPH_OFFSET *offsets;
+};
+
+struct shaped_run_cache
+{
+    struct list runs; /* most recently used first */
+    unsigned int count;
+};
+
+static RTL_CRITICAL_SECTION shaped_runs_cs;
+static RTL_CRITICAL_SECTION_DEBUG shaped_runs_cs_debug =
+{
+    0, 0, &shaped_runs_cs,
+    { &shaped_runs_cs_debug.ProcessLocksList, &shaped_runs_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": shaped_runs_cs") }
+};
+static RTL_CRITICAL_SECTION shaped_runs_cs = { &shaped_runs_cs_debug, -1, 0, 0, 0, 0 };
+
+static LONG shaped_runs_hits, shaped_runs_misses;
+
+static void release_shaped_run(struct shaped_run *run)
+{
+    heap_free((WCHAR *)run->key.string);
+    heap_free((WCHAR *)run->key.locale);
+    heap_free(run->key.features);
+    heap_free(run->glyphs);
+    heap_free(run->clustermap);
+    heap_free(run->glyph_props);
+    heap_free(run->advances);
+    heap_free(run->offsets);
+    heap_free(run);
+}
+
+void release_shaped_run_cache(struct shaped_run_cache *cache)
+{
+    struct shaped_run *run, *run2;
+
+    if (!cache)
+        return;
+
+    LIST_FOR_EACH_ENTRY_SAFE(run, run2, &cache->runs, struct shaped_run, entry)
+        release_shaped_run(run);
+    heap_free(cache);
+}
+
+static UINT32 shaped_run_hash(UINT32 hash, const void *data, SIZE_T size)
+{
+    const BYTE *ptr = data;
+
+    while (size--)
+        hash = (hash ^ *ptr++) * 16777619;
+    return hash;
+}
+
+static BOOL shaped_run_key_init(struct dwrite_textlayout *layout, const struct shaping_context *context,
+        struct shaped_run_key *key)
+{
+    const struct regular_layout_run *run = context->run;
+    unsigned int i, f, count = 0;
+    UINT32 hash = 2166136261;
+
+    memset(key, 0, sizeof(*key));
+
+    if (run->descr.stringLength > SHAPED_RUN_MAX_LENGTH)
+        return FALSE;
+
+    key->string = run->descr.string;
+    key->length = run->descr.stringLength;
+    key->locale = run->descr.localeName;
+    key->emsize = run->run.fontEmSize;
+    key->sa = run->sa;
+    key->is_sideways = run->run.isSideways;
+    key->is_rtl = run->run.bidiLevel & 1;
+    if ((key->gdi_compatible = is_layout_gdi_compatible(layout)))
+    {
+        key->gdi_natural = layout->measuringmode == DWRITE_MEASURING_MODE_GDI_NATURAL;
+        key->ppdip = layout->ppdip;
+        key->transform = layout->transform;
+    }
+
+    for (i = 0; i < context->user_features.range_count; ++i)
+        count += 2 + 2 * context->user_features.features[i]->featureCount;
+    if (count)
+    {
+        if (!(key->features = heap_calloc(count, sizeof(*key->features))))
+            return FALSE;
+
+        for (i = 0; i < context->user_features.range_count; ++i)
+        {
+            const DWRITE_TYPOGRAPHIC_FEATURES *features = context->user_features.features[i];
+
+            key->features[key->features_count++] = context->user_features.range_lengths[i];
+            key->features[key->features_count++] = features->featureCount;
+            for (f = 0; f < features->featureCount; ++f)
+            {
+                key->features[key->features_count++] = features->features[f].nameTag;
+                key->features[key->features_count++] = features->features[f].parameter;
+            }
+        }
+    }
+
+    hash = shaped_run_hash(hash, key->string, key->length * sizeof(WCHAR));
+    hash = shaped_run_hash(hash, &key->emsize, sizeof(key->emsize));
+    hash = shaped_run_hash(hash, &key->sa, sizeof(key->sa));
+    key->hash = shaped_run_hash(hash, key->features, key->features_count * sizeof(*key->features));
+
+    return TRUE;
+}
+
+static BOOL shaped_run_key_equal(const struct shaped_run_key *key, const struct shaped_run_key *other)
+{
+    return key->hash == other->hash &&
+            key->length == other->length &&
+            key->emsize == other->emsize &&
+            key->sa.script == other->sa.script &&
+            key->sa.shapes == other->sa.shapes &&
+            key->is_sideways == other->is_sideways &&
+            key->is_rtl == other->is_rtl &&
+            key->gdi_compatible == other->gdi_compatible &&
+            key->gdi_natural == other->gdi_natural &&
+            key->ppdip == other->ppdip &&
+            !memcmp(&key->transform, &other->transform, sizeof(key->transform)) &&
+            key->features_count == other->features_count &&
+            !memcmp(key->string, other->string, key->length * sizeof(WCHAR)) &&
+            !wcscmp(key->locale, other->locale) &&
+            !memcmp(key->features, other->features, key->features_count * sizeof(*key->features));
+}
+
+static void shaped_run_trace_stats(LONG hits, LONG misses)
+{
+    if ((hits + misses) % 1024) return;
+    TRACE("Shaped runs cache: %d hits, %d misses.\n", hits, misses);
+}
+
+static BOOL shaped_run_cache_get(const struct shaped_run_key *key, struct shaping_context *context)
+{
+    struct regular_layout_run *run = context->run;
+    struct dwrite_fontface *fontface;
+    struct shaped_run *cached;
+    BOOL found = FALSE;
+
+    fontface = unsafe_impl_from_IDWriteFontFace(run->run.fontFace);
+
+    EnterCriticalSection(&shaped_runs_cs);
+    if (fontface->shaped_runs)
+    {
+        LIST_FOR_EACH_ENTRY(cached, &fontface->shaped_runs->runs, struct shaped_run, entry)
+        {
+            if (!shaped_run_key_equal(key, &cached->key)) continue;
+
+            run->glyphcount = cached->glyph_count;
+            run->glyphs = heap_calloc(cached->glyph_count, sizeof(*run->glyphs));
+            run->clustermap = heap_calloc(key->length, sizeof(*run->clustermap));
+            run->advances = heap_calloc(cached->glyph_count, sizeof(*run->advances));
+            run->offsets = heap_calloc(cached->glyph_count, sizeof(*run->offsets));
+            context->glyph_props = heap_calloc(cached->glyph_count, sizeof(*context->glyph_props));
+            if (run->glyphs && run->clustermap && run->advances && run->offsets && context->glyph_props)
+            {
+                memcpy(run->glyphs, cached->glyphs, cached->glyph_count * sizeof(*run->glyphs));
+                memcpy(run->clustermap, cached->clustermap, key->length * sizeof(*run->clustermap));
+                memcpy(run->advances, cached->advances, cached->glyph_count * sizeof(*run->advances));
+                memcpy(run->offsets, cached->offsets, cached->glyph_count * sizeof(*run->offsets));
+                memcpy(context->glyph_props, cached->glyph_props, cached->glyph_count * sizeof(*context->glyph_props));
+                list_remove(&cached->entry);
+                list_add_head(&fontface->shaped_runs->runs, &cached->entry);
+                found = TRUE;
+            }
+            else
+            {
+                heap_free(run->glyphs);
+                heap_free(run->clustermap);
+                heap_free(run->advances);
+                heap_free(run->offsets);
+                heap_free(context->glyph_props);
+                run->glyphs = run->clustermap = NULL;
+                run->advances = NULL;
+                run->offsets = NULL;
+                context->glyph_props = NULL;
+            }
+            break;
+        }
+    }
+    LeaveCriticalSection(&shaped_runs_cs);
+
+    if (found)
+    {
+        run->run.glyphIndices = run->glyphs;
+        run->descr.clusterMap = run->clustermap;
+        run->run.glyphAdvances = run->advances;
+        run->run.glyphOffsets = run->offsets;
+        shaped_run_trace_stats(InterlockedIncrement(&shaped_runs_hits), shaped_runs_misses);
+    }
+    else
+        shaped_run_trace_stats(shaped_runs_hits, InterlockedIncrement(&shaped_runs_misses));
+
+    return found;
+}
+
+static void shaped_run_cache_put(const struct shaped_run_key *key, const struct shaping_context *context)
+{
+    struct regular_layout_run *run = context->run;
+    struct dwrite_fontface *fontface;
+    struct shaped_run *cached;
+
+    if (!(cached = heap_alloc_zero(sizeof(*cached))))
+        return;
+
+    cached->key = *key;
+    cached->key.string = heap_strdupnW(key->string, key->length);
+    cached->key.locale = heap_strdupW(key->locale);
+    if (key->features_count && (cached->key.features = heap_calloc(key->features_count, sizeof(*key->features))))
+        memcpy(cached->key.features, key->features, key->features_count * sizeof(*key->features));
+    cached->glyph_count = run->glyphcount;
+    cached->glyphs = heap_calloc(run->glyphcount, sizeof(*cached->glyphs));
+    cached->clustermap = heap_calloc(key->length, sizeof(*cached->clustermap));
+    cached->glyph_props = heap_calloc(run->glyphcount, sizeof(*cached->glyph_props));
+    cached->advances = heap_calloc(run->glyphcount, sizeof(*cached->advances));
+    cached->offsets = heap_calloc(run->glyphcount, sizeof(*cached->offsets));
+    if (!cached->key.string || !cached->key.locale || (key->features_count && !cached->key.features) ||
+            !cached->glyphs || !cached->clustermap || !cached->glyph_props || !cached->advances || !cached->offsets)
+    {
+        release_shaped_run(cached);
+        return;
+    }
+    memcpy(cached->glyphs, run->glyphs, run->glyphcount * sizeof(*cached->glyphs));
+    memcpy(cached->clustermap, run->clustermap, key->length * sizeof(*cached->clustermap));
+    memcpy(cached->glyph_props, context->glyph_props, run->glyphcount * sizeof(*cached->glyph_props));
+    memcpy(cached->advances, run->advances, run->glyphcount * sizeof(*cached->advances));
+    memcpy(cached->offsets, run->offsets, run->glyphcount * sizeof(*cached->offsets));
+
+    fontface = unsafe_impl_from_IDWriteFontFace(run->run.fontFace);
+
+    EnterCriticalSection(&shaped_runs_cs);
+    if (!fontface->shaped_runs && (fontface->shaped_runs = heap_alloc_zero(sizeof(*fontface->shaped_runs))))
+        list_init(&fontface->shaped_runs->runs);
+    if (fontface->shaped_runs)
+    {
+        list_add_head(&fontface->shaped_runs->runs, &cached->entry);
+        if (++fontface->shaped_runs->count > SHAPED_RUN_CACHE_SIZE)
+        {
+            struct shaped_run *oldest = LIST_ENTRY(list_tail(&fontface->shaped_runs->runs), struct shaped_run, entry);
+            list_remove(&oldest->entry);
+            fontface->shaped_runs->count--;
+            cached = oldest;
+        }
+        else
+            cached = NULL;
+    }
+    LeaveCriticalSection(&shaped_runs_cs);
+
+    if (cached)
+        release_shaped_run(cached);
+}
+
 static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular_layout_run *run)
 {
     struct shaping_context context = { 0 };
     HRESULT hr;
 
+    struct shaped_run_key key;
+
     context.analyzer = get_text_analyzer();
     context.run = run;
 
-    if (SUCCEEDED(hr = layout_shape_get_glyphs(layout, &context)))
-        hr = layout_shape_get_positions(layout, &context);
+    run->descr.localeName = get_layout_range_by_pos(layout, run->descr.textPosition)->locale;
+
+    if (SUCCEEDED(hr = layout_shape_get_user_features(layout, &context)))
+    {
+        BOOL cacheable = shaped_run_key_init(layout, &context, &key);
+
+        if (!cacheable || !shaped_run_cache_get(&key, &context))
+        {
+            if (SUCCEEDED(hr = layout_shape_get_glyphs(layout, &context)) &&
+                    SUCCEEDED(hr = layout_shape_get_positions(layout, &context)) && cacheable)
+                shaped_run_cache_put(&key, &context);
+        }
+
+        /* Spacing depends on layout ranges, it's applied on top of cached positions. */
+        if (SUCCEEDED(hr))
+            hr = layout_shape_apply_character_spacing(layout, &context);
+
+        heap_free(key.features);
+    }
 
     layout_shape_clear_context(&context);
 
@@ -6489,6 +6489,73 @@ if (SUCCEEDED(hr))
     IDWriteFactory_Release(factory);
 }
 
+static void test_repeated_layouts(void)
+{
+    DWRITE_CLUSTER_METRICS metrics[6], metrics2[6];
+    IDWriteTextLayout1 *layout1;
+    IDWriteTextFormat *format;
+    IDWriteTextLayout *layout;
+    IDWriteFactory *factory;
+    DWRITE_TEXT_RANGE range;
+    UINT32 count, count2, i;
+    HRESULT hr;
+
+    factory = create_factory();
+
+    hr = IDWriteFactory_CreateTextFormat(factory, L"Tahoma", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL, 10.0f, L"en-us", &format);
+    ok(hr == S_OK, "Failed to create text format, hr %#x.\n", hr);
+
+    hr = IDWriteFactory_CreateTextLayout(factory, L"string", 6, format, 100.0f, 100.0f, &layout);
+    ok(hr == S_OK, "Failed to create text layout, hr %#x.\n", hr);
+    count = 0;
+    hr = IDWriteTextLayout_GetClusterMetrics(layout, metrics, ARRAY_SIZE(metrics), &count);
+    ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+    ok(count == 6, "Unexpected cluster count %u.\n", count);
+    IDWriteTextLayout_Release(layout);
+
+    /* Spacing applied to one layout does not affect other layouts with the same text. */
+    hr = IDWriteFactory_CreateTextLayout(factory, L"string", 6, format, 100.0f, 100.0f, &layout);
+    ok(hr == S_OK, "Failed to create text layout, hr %#x.\n", hr);
+    if (IDWriteTextLayout_QueryInterface(layout, &IID_IDWriteTextLayout1, (void **)&layout1) == S_OK)
+    {
+        range.startPosition = 0;
+        range.length = 6;
+        hr = IDWriteTextLayout1_SetCharacterSpacing(layout1, 10.0f, 0.0f, 0.0f, range);
+        ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+
+        count2 = 0;
+        hr = IDWriteTextLayout_GetClusterMetrics(layout, metrics2, ARRAY_SIZE(metrics2), &count2);
+        ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+        ok(count2 == count, "Unexpected cluster count %u.\n", count2);
+        for (i = 0; i < count2; ++i)
+            ok(metrics2[i].width > metrics[i].width, "%u: unexpected width %.2f, was %.2f.\n", i,
+                    metrics2[i].width, metrics[i].width);
+
+        IDWriteTextLayout1_Release(layout1);
+    }
+    else
+        win_skip("IDWriteTextLayout1 is not supported.\n");
+    IDWriteTextLayout_Release(layout);
+
+    hr = IDWriteFactory_CreateTextLayout(factory, L"string", 6, format, 100.0f, 100.0f, &layout);
+    ok(hr == S_OK, "Failed to create text layout, hr %#x.\n", hr);
+    count2 = 0;
+    hr = IDWriteTextLayout_GetClusterMetrics(layout, metrics2, ARRAY_SIZE(metrics2), &count2);
+    ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+    ok(count2 == count, "Unexpected cluster count %u.\n", count2);
+    for (i = 0; i < count2; ++i)
+    {
+        ok(metrics2[i].width == metrics[i].width, "%u: unexpected width %.2f, expected %.2f.\n", i,
+                metrics2[i].width, metrics[i].width);
+        ok(metrics2[i].length == metrics[i].length, "%u: unexpected length %u.\n", i, metrics2[i].length);
+    }
+    IDWriteTextLayout_Release(layout);
+
+    IDWriteTextFormat_Release(format);
+    IDWriteFactory_Release(factory);
+}
+
 START_TEST(layout)
 {
     IDWriteFactory *factory;
@@ -6544,6 +6611,7 @@ START_TEST(layout)
     test_text_format_axes();
     test_layout_range_length();
     test_HitTestTextRange();
+    test_repeated_layouts();
 
     IDWriteFactory_Release(factory);
 }
@@ -27,11 +27,158 @@
 #include "evr.h"
 
 #include "wine/debug.h"
+#include "wine/list.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(mfplat);
 
 #define ALIGN_SIZE(size, alignment) (((size) + (alignment)) & ~((alignment)))
 
+/* Freed buffer memory of the same allocation size is kept for reuse, so that
+   pipelines creating a buffer per frame don't churn the heap. */
+#define POOL_MIN_BLOCK_SIZE     0x4000
+#define POOL_MAX_BLOCKS         8   /* per size */
+#define POOL_MAX_BUCKETS        32
+#define POOL_MAX_TOTAL_SIZE     (64 * 1024 * 1024)
+
+struct pool_bucket
+{
+    struct list entry;
+    SIZE_T size;
+    struct list blocks;
+    unsigned int count;
+};
+
+static struct
+{
+    struct list buckets;
+    unsigned int bucket_count;
+    SIZE_T total_size;
+    LONG64 hits;
+    LONG64 misses;
+} buffer_pool = { LIST_INIT(buffer_pool.buckets) };
+
+static CRITICAL_SECTION buffer_pool_cs;
+static CRITICAL_SECTION_DEBUG buffer_pool_cs_debug =
+{
+    0, 0, &buffer_pool_cs,
+    { &buffer_pool_cs_debug.ProcessLocksList, &buffer_pool_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": buffer_pool_cs") }
+};
+static CRITICAL_SECTION buffer_pool_cs = { &buffer_pool_cs_debug, -1, 0, 0, 0, 0 };
+
+static struct pool_bucket *buffer_pool_get_bucket(SIZE_T size, BOOL create)
+{
+    struct pool_bucket *bucket, *empty = NULL;
+
+    LIST_FOR_EACH_ENTRY(bucket, &buffer_pool.buckets, struct pool_bucket, entry)
+    {
+        if (bucket->size == size)
+            return bucket;
+        if (!bucket->count)
+            empty = bucket;
+    }
+
+    if (!create)
+        return NULL;
+
+    /* Sizes that are no longer in use give up their bucket. */
+    if (buffer_pool.bucket_count >= POOL_MAX_BUCKETS)
+    {
+        if (empty)
+            empty->size = size;
+        return empty;
+    }
+
+    if (!(bucket = calloc(1, sizeof(*bucket))))
+        return NULL;
+    bucket->size = size;
+    list_init(&bucket->blocks);
+    list_add_tail(&buffer_pool.buckets, &bucket->entry);
+    buffer_pool.bucket_count++;
+    return bucket;
+}
+
+static void *buffer_pool_alloc(SIZE_T size)
+{
+    struct pool_bucket *bucket;
+    struct list *block = NULL;
+
+    if (size < POOL_MIN_BLOCK_SIZE)
+        return calloc(1, size);
+
+    EnterCriticalSection(&buffer_pool_cs);
+    if ((bucket = buffer_pool_get_bucket(size, FALSE)) && (block = list_head(&bucket->blocks)))
+    {
+        list_remove(block);
+        bucket->count--;
+        buffer_pool.total_size -= size;
+        buffer_pool.hits++;
+    }
+    else
+        buffer_pool.misses++;
+    if (!((buffer_pool.hits + buffer_pool.misses) % 1024))
+        TRACE("Buffer pool: %s hits, %s misses, %Iu bytes cached.\n", wine_dbgstr_longlong(buffer_pool.hits),
+                wine_dbgstr_longlong(buffer_pool.misses), buffer_pool.total_size);
+    LeaveCriticalSection(&buffer_pool_cs);
+
+    if (!block)
+        return calloc(1, size);
+
+    /* Hand out the same zeroed memory as a fresh allocation. */
+    memset(block, 0, size);
+    return block;
+}
+
+static void buffer_pool_free(void *data, SIZE_T size)
+{
+    struct pool_bucket *bucket;
+
+    if (!data)
+        return;
+
+    if (size >= POOL_MIN_BLOCK_SIZE)
+    {
+        EnterCriticalSection(&buffer_pool_cs);
+        if (buffer_pool.total_size + size <= POOL_MAX_TOTAL_SIZE
+                && (bucket = buffer_pool_get_bucket(size, TRUE)) && bucket->count < POOL_MAX_BLOCKS)
+        {
+            list_add_head(&bucket->blocks, (struct list *)data);
+            bucket->count++;
+            buffer_pool.total_size += size;
+            data = NULL;
+        }
+        LeaveCriticalSection(&buffer_pool_cs);
+    }
+
+    free(data);
+}
+
+void release_buffer_pool(void)
+{
+    struct pool_bucket *bucket, *next_bucket;
+    struct list *block;
+
+    EnterCriticalSection(&buffer_pool_cs);
+
+    TRACE("Buffer pool: %s hits, %s misses.\n", wine_dbgstr_longlong(buffer_pool.hits),
+            wine_dbgstr_longlong(buffer_pool.misses));
+
+    LIST_FOR_EACH_ENTRY_SAFE(bucket, next_bucket, &buffer_pool.buckets, struct pool_bucket, entry)
+    {
+        while ((block = list_head(&bucket->blocks)))
+        {
+            list_remove(block);
+            free(block);
+        }
+        list_remove(&bucket->entry);
+        free(bucket);
+    }
+    buffer_pool.bucket_count = 0;
+    buffer_pool.total_size = 0;
+
+    LeaveCriticalSection(&buffer_pool_cs);
+}
+
 typedef void (*p_copy_image_func)(BYTE *dest, LONG dest_stride, const BYTE *src, LONG src_stride, DWORD width, DWORD lines);
 
 struct buffer
@@ -43,6 +190,7 @@ struct buffer
     LONG refcount;
 
     BYTE *data;
+    SIZE_T alloc_size;
     DWORD max_length;
     DWORD current_length;
 
@@ -172,8 +320,8 @@ static ULONG WINAPI memory_buffer_Release(IMFMediaBuffer *iface)
             clear_attributes_object(&buffer->dxgi_surface.attributes);
         }
         DeleteCriticalSection(&buffer->cs);
-        free(buffer->_2d.linear_buffer);
-        free(buffer->data);
+        buffer_pool_free(buffer->_2d.linear_buffer, ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT));
+        buffer_pool_free(buffer->data, buffer->alloc_size);
         free(buffer);
     }
 
@@ -309,7 +457,7 @@ static HRESULT WINAPI memory_1d_2d_buffer_Lock(IMFMediaBuffer *iface, BYTE **dat
         hr = MF_E_INVALIDREQUEST;
     else if (!buffer->_2d.linear_buffer)
     {
-        if (!(buffer->_2d.linear_buffer = malloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
+        if (!(buffer->_2d.linear_buffer = buffer_pool_alloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
             hr = E_OUTOFMEMORY;
     }
 
@@ -341,7 +489,7 @@ static HRESULT WINAPI memory_1d_2d_buffer_Unlock(IMFMediaBuffer *iface)
         copy_image(buffer, buffer->data, buffer->_2d.pitch, buffer->_2d.linear_buffer, buffer->_2d.width,
                 buffer->_2d.width, buffer->_2d.height);
 
-        free(buffer->_2d.linear_buffer);
+        buffer_pool_free(buffer->_2d.linear_buffer, ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT));
         buffer->_2d.linear_buffer = NULL;
     }
 
@@ -380,7 +528,7 @@ static HRESULT WINAPI d3d9_surface_buffer_Lock(IMFMediaBuffer *iface, BYTE **dat
     {
         D3DLOCKED_RECT rect;
 
-        if (!(buffer->_2d.linear_buffer = malloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
+        if (!(buffer->_2d.linear_buffer = buffer_pool_alloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
             hr = E_OUTOFMEMORY;
 
         if (SUCCEEDED(hr))
@@ -432,7 +580,7 @@ static HRESULT WINAPI d3d9_surface_buffer_Unlock(IMFMediaBuffer *iface)
             IDirect3DSurface9_UnlockRect(buffer->d3d9_surface.surface);
         }
 
-        free(buffer->_2d.linear_buffer);
+        buffer_pool_free(buffer->_2d.linear_buffer, ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT));
         buffer->_2d.linear_buffer = NULL;
     }
 
@@ -959,7 +1107,7 @@ static HRESULT WINAPI dxgi_surface_buffer_Lock(IMFMediaBuffer *iface, BYTE **dat
         hr = MF_E_INVALIDREQUEST;
     else if (!buffer->_2d.linear_buffer)
     {
-        if (!(buffer->_2d.linear_buffer = malloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
+        if (!(buffer->_2d.linear_buffer = buffer_pool_alloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
             hr = E_OUTOFMEMORY;
 
         if (SUCCEEDED(hr))
@@ -1005,7 +1153,7 @@ static HRESULT WINAPI dxgi_surface_buffer_Unlock(IMFMediaBuffer *iface)
                 buffer->_2d.linear_buffer, buffer->_2d.width, buffer->_2d.width, buffer->_2d.height);
         dxgi_surface_buffer_unmap(buffer);
 
-        free(buffer->_2d.linear_buffer);
+        buffer_pool_free(buffer->_2d.linear_buffer, ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT));
         buffer->_2d.linear_buffer = NULL;
     }
 
@@ -1256,7 +1404,8 @@ static const IMFDXGIBufferVtbl dxgi_buffer_vtbl =
 static HRESULT memory_buffer_init(struct buffer *buffer, DWORD max_length, DWORD alignment,
         const IMFMediaBufferVtbl *vtbl)
 {
-    if (!(buffer->data = calloc(1, ALIGN_SIZE(max_length, alignment))))
+    buffer->alloc_size = ALIGN_SIZE(max_length, alignment);
+    if (!(buffer->data = buffer_pool_alloc(buffer->alloc_size)))
         return E_OUTOFMEMORY;
 
     buffer->IMFMediaBuffer_iface.lpVtbl = vtbl;
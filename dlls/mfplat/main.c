@@ -1455,6 +1455,7 @@ HRESULT WINAPI MFShutdown(void)
     TRACE("\n");
 
     RtwqShutdown();
+    release_buffer_pool();
 
     return S_OK;
 }
@@ -455,6 +455,56 @@ cleanup:
     CoTaskMemFree(pwfx);
 }
 
+static void test_audioclient3(void)
+{
+    UINT32 default_period, unit_period, min_period, max_period, cur_period, frames;
+    WAVEFORMATEX *pwfx, *cur_fmt;
+    IAudioClient3 *ac3;
+    HRESULT hr;
+
+    hr = IMMDevice_Activate(dev, &IID_IAudioClient3, CLSCTX_INPROC_SERVER,
+            NULL, (void**)&ac3);
+    if(hr != S_OK){
+        win_skip("IAudioClient3 not supported\n");
+        return;
+    }
+
+    hr = IAudioClient3_GetMixFormat(ac3, &pwfx);
+    ok(hr == S_OK, "GetMixFormat failed: %08x\n", hr);
+
+    hr = IAudioClient3_GetSharedModeEnginePeriod(ac3, pwfx, &default_period, &unit_period,
+            &min_period, &max_period);
+    if(hr == E_NOTIMPL){
+        skip("GetSharedModeEnginePeriod not implemented\n");
+        goto cleanup;
+    }
+    ok(hr == S_OK, "GetSharedModeEnginePeriod failed: %08x\n", hr);
+    ok(unit_period > 0, "Got unit period %u\n", unit_period);
+    ok(min_period <= default_period && default_period <= max_period,
+            "Got periods min %u, default %u, max %u\n", min_period, default_period, max_period);
+    trace("engine periods: default %u, unit %u, min %u, max %u\n",
+            default_period, unit_period, min_period, max_period);
+
+    hr = IAudioClient3_GetCurrentSharedModeEnginePeriod(ac3, &cur_fmt, &cur_period);
+    ok(hr == S_OK, "GetCurrentSharedModeEnginePeriod failed: %08x\n", hr);
+    ok(cur_period >= min_period && cur_period <= max_period, "Got current period %u\n", cur_period);
+    CoTaskMemFree(cur_fmt);
+
+    hr = IAudioClient3_InitializeSharedAudioStream(ac3, 0, min_period, pwfx, NULL);
+    ok(hr == S_OK, "InitializeSharedAudioStream failed: %08x\n", hr);
+
+    hr = IAudioClient3_GetBufferSize(ac3, &frames);
+    ok(hr == S_OK, "GetBufferSize failed: %08x\n", hr);
+    ok(frames >= min_period, "Got buffer size %u, period %u\n", frames, min_period);
+
+    hr = IAudioClient3_InitializeSharedAudioStream(ac3, 0, min_period, pwfx, NULL);
+    ok(hr == AUDCLNT_E_ALREADY_INITIALIZED, "InitializeSharedAudioStream returns %08x\n", hr);
+
+cleanup:
+    IAudioClient3_Release(ac3);
+    CoTaskMemFree(pwfx);
+}
+
 static void test_formats(AUDCLNT_SHAREMODE mode)
 {
     IAudioClient *ac;
@@ -2383,6 +2433,7 @@ START_TEST(render)
     }
 
     test_audioclient();
+    test_audioclient3();
     test_formats(AUDCLNT_SHAREMODE_EXCLUSIVE);
     test_formats(AUDCLNT_SHAREMODE_SHARED);
     test_references();
@@ -24,6 +24,7 @@
 #endif
 
 #include "config.h"
+#include <errno.h>
 #include <stdarg.h>
 
 #ifdef HAVE_SYS_PARAM_H
@@ -90,6 +91,12 @@
 #include <libproc.h>
 #endif
 
+#ifdef HAVE_LINUX_INET_DIAG_H
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#endif
+
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
 #include "windef.h"
@@ -245,6 +252,19 @@ static inline MIB_TCP_STATE tcp_state_to_mib_state( int state )
    }
 }
 
+/* kernel socket states to ask for when looking for connections in the given MIB state */
+static unsigned int tcp_states_mask( DWORD filter )
+{
+    unsigned int mask = 0;
+    int state;
+
+    if (!filter) return ~0u;
+
+    for (state = 0; state <= TCPS_CLOSING; state++)
+        if (tcp_state_to_mib_state( state ) == filter) mask |= 1u << state;
+    return mask;
+}
+
 struct ipv6_addr_scope *get_ipv6_addr_scope_table( unsigned int *size )
 {
     struct ipv6_addr_scope *table = NULL;
@@ -524,6 +544,117 @@ unsigned int find_owning_pid( struct pid_map *map, unsigned int num_entries, UIN
 #endif
 }
 
+/* Retrieve the sockets of the given family and protocol in one of the given states
+ * through NETLINK_SOCK_DIAG. Returns NULL if the interface is not available. */
+struct diag_socket *get_diag_sockets( int family, int protocol, unsigned int states, unsigned int *count )
+{
+#if defined(HAVE_LINUX_INET_DIAG_H) && defined(SOCK_DIAG_BY_FAMILY)
+    struct
+    {
+        struct nlmsghdr hdr;
+        struct inet_diag_req_v2 req;
+    } request;
+    struct sockaddr_nl addr;
+    struct diag_socket *socks = NULL, *new_socks;
+    unsigned int size = 0, num = 0;
+    struct nlmsghdr buf[8192 / sizeof(struct nlmsghdr)];
+    BOOL done = FALSE;
+    int fd;
+
+    if ((fd = socket( AF_NETLINK, SOCK_DGRAM, NETLINK_SOCK_DIAG )) == -1) return NULL;
+
+    memset( &addr, 0, sizeof(addr) );
+    addr.nl_family = AF_NETLINK;
+
+    memset( &request, 0, sizeof(request) );
+    request.hdr.nlmsg_len = sizeof(request);
+    request.hdr.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    request.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.req.sdiag_family = family;
+    request.req.sdiag_protocol = protocol;
+    request.req.idiag_states = states;
+
+    if (sendto( fd, &request, sizeof(request), 0, (struct sockaddr *)&addr, sizeof(addr) ) != sizeof(request))
+        goto failed;
+
+    while (!done)
+    {
+        struct iovec iov = { buf, sizeof(buf) };
+        struct msghdr msghdr;
+        struct nlmsghdr *hdr;
+        int len;
+
+        memset( &msghdr, 0, sizeof(msghdr) );
+        msghdr.msg_iov = &iov;
+        msghdr.msg_iovlen = 1;
+        if ((len = recvmsg( fd, &msghdr, 0 )) <= 0)
+        {
+            if (len < 0 && errno == EINTR) continue;
+            goto failed;
+        }
+        /* a partial dump must not be mistaken for the whole table */
+        if (msghdr.msg_flags & MSG_TRUNC)
+        {
+            WARN( "netlink message truncated\n" );
+            goto failed;
+        }
+
+        for (hdr = buf; NLMSG_OK( hdr, len ); hdr = NLMSG_NEXT( hdr, len ))
+        {
+            const struct inet_diag_msg *msg = NLMSG_DATA( hdr );
+
+            if (hdr->nlmsg_type == NLMSG_DONE)
+            {
+                done = TRUE;
+                break;
+            }
+            if (hdr->nlmsg_type == NLMSG_ERROR)
+            {
+                const struct nlmsgerr *err = NLMSG_DATA( hdr );
+
+                if (hdr->nlmsg_len >= NLMSG_LENGTH( sizeof(*err) ))
+                    TRACE( "family %d protocol %d failed, error %d\n", family, protocol, -err->error );
+                goto failed;
+            }
+            if (hdr->nlmsg_type != SOCK_DIAG_BY_FAMILY || hdr->nlmsg_len < NLMSG_LENGTH( sizeof(*msg) ))
+                continue;
+
+            if (num == size)
+            {
+                size = max( size * 2, 256 );
+                if (!(new_socks = realloc( socks, size * sizeof(*socks) ))) goto failed;
+                socks = new_socks;
+            }
+            socks[num].state = msg->idiag_state;
+            memcpy( socks[num].local_addr, msg->id.idiag_src, sizeof(socks[num].local_addr) );
+            memcpy( socks[num].remote_addr, msg->id.idiag_dst, sizeof(socks[num].remote_addr) );
+            socks[num].local_port = msg->id.idiag_sport;
+            socks[num].remote_port = msg->id.idiag_dport;
+            socks[num].inode = msg->idiag_inode;
+            num++;
+        }
+        if (!done && len)
+        {
+            WARN( "incomplete netlink message\n" );
+            goto failed;
+        }
+    }
+
+    close( fd );
+    /* an empty table is still a valid answer */
+    if (!socks) socks = malloc( sizeof(*socks) );
+    *count = num;
+    return socks;
+
+failed:
+    close( fd );
+    free( socks );
+    return NULL;
+#else
+    return NULL;
+#endif
+}
+
 static NTSTATUS tcp_conns_enumerate_all( DWORD filter, struct nsi_tcp_conn_key *key_data, DWORD key_size,
                                          void *rw, DWORD rw_size,
                                          struct nsi_tcp_conn_dynamic *dynamic_data, DWORD dynamic_size,
@@ -544,52 +675,119 @@ static NTSTATUS tcp_conns_enumerate_all( DWORD filter, struct nsi_tcp_conn_key *
         FILE *fp;
         char buf[512], *ptr;
         int inode;
-
-        if (!(fp = fopen( "/proc/net/tcp", "r" ))) return ERROR_NOT_SUPPORTED;
+        struct diag_socket *socks;
+        unsigned int i, socks_count;
 
         memset( &key, 0, sizeof(key) );
         memset( &dyn, 0, sizeof(dyn) );
         memset( &stat, 0, sizeof(stat) );
-        pid_map = get_pid_map( &pid_map_size );
+        stat.create_time = 0; /* FIXME */
+        stat.mod_info = 0; /* FIXME */
+        /* looking up the owner is expensive, only do it if it was asked for */
+        if (static_data) pid_map = get_pid_map( &pid_map_size );
 
-        /* skip header line */
-        ptr = fgets( buf, sizeof(buf), fp );
-        while ((ptr = fgets( buf, sizeof(buf), fp )))
+        if ((socks = get_diag_sockets( AF_INET, IPPROTO_TCP, tcp_states_mask( filter ), &socks_count )))
         {
-            if (sscanf( ptr, "%*x: %x:%hx %x:%hx %x %*s %*s %*s %*s %*s %d",
-                        &key.local.Ipv4.sin_addr.WS_s_addr, &key.local.Ipv4.sin_port,
-                        &key.remote.Ipv4.sin_addr.WS_s_addr, &key.remote.Ipv4.sin_port,
-                        &dyn.state, &inode ) != 6)
-                continue;
-            dyn.state = tcp_state_to_mib_state( dyn.state );
-            if (filter && filter != dyn.state ) continue;
+            for (i = 0; i < socks_count; i++)
+            {
+                dyn.state = tcp_state_to_mib_state( socks[i].state );
+                if (filter && filter != dyn.state ) continue;
 
-            key.local.Ipv4.sin_family = key.remote.Ipv4.sin_family = WS_AF_INET;
-            key.local.Ipv4.sin_port = htons( key.local.Ipv4.sin_port );
-            key.remote.Ipv4.sin_port = htons( key.remote.Ipv4.sin_port );
+                key.local.Ipv4.sin_family = key.remote.Ipv4.sin_family = WS_AF_INET;
+                key.local.Ipv4.sin_addr.WS_s_addr = socks[i].local_addr[0];
+                key.local.Ipv4.sin_port = socks[i].local_port;
+                key.remote.Ipv4.sin_addr.WS_s_addr = socks[i].remote_addr[0];
+                key.remote.Ipv4.sin_port = socks[i].remote_port;
 
-            stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
-            stat.create_time = 0; /* FIXME */
-            stat.mod_info = 0; /* FIXME */
+                if (num < *count)
+                {
+                    if (key_data) *key_data++ = key;
+                    if (dynamic_data) *dynamic_data++ = dyn;
+                    if (static_data)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, socks[i].inode );
+                        *static_data++ = stat;
+                    }
+                }
+                num++;
+            }
+            free( socks );
+        }
+        else
+        {
+            if (!(fp = fopen( "/proc/net/tcp", "r" )))
+            {
+                free( pid_map );
+                return ERROR_NOT_SUPPORTED;
+            }
 
-            if (num < *count)
+            /* skip header line */
+            ptr = fgets( buf, sizeof(buf), fp );
+            while ((ptr = fgets( buf, sizeof(buf), fp )))
             {
-                if (key_data) *key_data++ = key;
-                if (dynamic_data) *dynamic_data++ = dyn;
-                if (static_data) *static_data++ = stat;
+                if (sscanf( ptr, "%*x: %x:%hx %x:%hx %x %*s %*s %*s %*s %*s %d",
+                            &key.local.Ipv4.sin_addr.WS_s_addr, &key.local.Ipv4.sin_port,
+                            &key.remote.Ipv4.sin_addr.WS_s_addr, &key.remote.Ipv4.sin_port,
+                            &dyn.state, &inode ) != 6)
+                    continue;
+                dyn.state = tcp_state_to_mib_state( dyn.state );
+                if (filter && filter != dyn.state ) continue;
+
+                key.local.Ipv4.sin_family = key.remote.Ipv4.sin_family = WS_AF_INET;
+                key.local.Ipv4.sin_port = htons( key.local.Ipv4.sin_port );
+                key.remote.Ipv4.sin_port = htons( key.remote.Ipv4.sin_port );
+
+                if (num < *count)
+                {
+                    if (key_data) *key_data++ = key;
+                    if (dynamic_data) *dynamic_data++ = dyn;
+                    if (static_data)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
+                        *static_data++ = stat;
+                    }
+                }
+                num++;
             }
-            num++;
+            fclose( fp );
         }
-        fclose( fp );
 
-        if ((fp = fopen( "/proc/net/tcp6", "r" )))
+        memset( &key, 0, sizeof(key) );
+        addr_scopes = get_ipv6_addr_scope_table( &addr_scopes_size );
+
+        if ((socks = get_diag_sockets( AF_INET6, IPPROTO_TCP, tcp_states_mask( filter ), &socks_count )))
         {
-            memset( &key, 0, sizeof(key) );
-            memset( &dyn, 0, sizeof(dyn) );
-            memset( &stat, 0, sizeof(stat) );
+            for (i = 0; i < socks_count; i++)
+            {
+                dyn.state = tcp_state_to_mib_state( socks[i].state );
+                if (filter && filter != dyn.state ) continue;
 
-            addr_scopes = get_ipv6_addr_scope_table( &addr_scopes_size );
+                key.local.Ipv6.sin6_family = key.remote.Ipv6.sin6_family = WS_AF_INET6;
+                memcpy( &key.local.Ipv6.sin6_addr, socks[i].local_addr, sizeof(key.local.Ipv6.sin6_addr) );
+                key.local.Ipv6.sin6_port = socks[i].local_port;
+                key.local.Ipv6.sin6_scope_id = find_ipv6_addr_scope( &key.local.Ipv6.sin6_addr, addr_scopes,
+                                                                     addr_scopes_size );
+                memcpy( &key.remote.Ipv6.sin6_addr, socks[i].remote_addr, sizeof(key.remote.Ipv6.sin6_addr) );
+                key.remote.Ipv6.sin6_port = socks[i].remote_port;
+                key.remote.Ipv6.sin6_scope_id = find_ipv6_addr_scope( &key.remote.Ipv6.sin6_addr, addr_scopes,
+                                                                      addr_scopes_size );
 
+                if (num < *count)
+                {
+                    if (key_data) *key_data++ = key;
+                    if (dynamic_data) *dynamic_data++ = dyn;
+                    if (static_data)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, socks[i].inode );
+                        *static_data++ = stat;
+                    }
+                }
+                num++;
+            }
+            free( socks );
+        }
+        else if ((fp = fopen( "/proc/net/tcp6", "r" )))
+        {
             /* skip header line */
             ptr = fgets( buf, sizeof(buf), fp );
             while ((ptr = fgets( buf, sizeof(buf), fp )))
@@ -612,15 +810,15 @@ static NTSTATUS tcp_conns_enumerate_all( DWORD filter, struct nsi_tcp_conn_key *
                 key.remote.Ipv6.sin6_scope_id = find_ipv6_addr_scope( &key.remote.Ipv6.sin6_addr, addr_scopes,
                                                                       addr_scopes_size );
 
-                stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
-                stat.create_time = 0; /* FIXME */
-                stat.mod_info = 0; /* FIXME */
-
                 if (num < *count)
                 {
                     if (key_data) *key_data++ = key;
                     if (dynamic_data) *dynamic_data++ = dyn;
-                    if (static_data) *static_data++ = stat;
+                    if (static_data)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
+                        *static_data++ = stat;
+                    }
                 }
                 num++;
             }
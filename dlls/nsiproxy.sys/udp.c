@@ -229,45 +229,99 @@ static NTSTATUS udp_endpoint_enumerate_all( void *key_data, DWORD key_size, void
         FILE *fp;
         char buf[512], *ptr;
         int inode;
-
-        if (!(fp = fopen( "/proc/net/udp", "r" ))) return ERROR_NOT_SUPPORTED;
+        struct diag_socket *socks;
+        unsigned int i, socks_count;
 
         memset( &key, 0, sizeof(key) );
         memset( &stat, 0, sizeof(stat) );
-        pid_map = get_pid_map( &pid_map_size );
+        stat.create_time = 0; /* FIXME */
+        stat.flags = 0; /* FIXME */
+        stat.mod_info = 0; /* FIXME */
+        /* looking up the owner is expensive, only do it if it was asked for */
+        if (stat_out) pid_map = get_pid_map( &pid_map_size );
 
-        /* skip header line */
-        ptr = fgets( buf, sizeof(buf), fp );
-        while ((ptr = fgets( buf, sizeof(buf), fp )))
+        if ((socks = get_diag_sockets( AF_INET, IPPROTO_UDP, ~0u, &socks_count )))
         {
-            if (sscanf( ptr, "%*u: %x:%hx %*s %*s %*s %*s %*s %*s %*s %d",
-                        &key.local.Ipv4.sin_addr.WS_s_addr, &key.local.Ipv4.sin_port, &inode ) != 3)
-                continue;
-
-            key.local.Ipv4.sin_family = WS_AF_INET;
-            key.local.Ipv4.sin_port = htons( key.local.Ipv4.sin_port );
+            for (i = 0; i < socks_count; i++)
+            {
+                key.local.Ipv4.sin_family = WS_AF_INET;
+                key.local.Ipv4.sin_addr.WS_s_addr = socks[i].local_addr[0];
+                key.local.Ipv4.sin_port = socks[i].local_port;
 
-            stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
-            stat.create_time = 0; /* FIXME */
-            stat.flags = 0; /* FIXME */
-            stat.mod_info = 0; /* FIXME */
+                if (num < *count)
+                {
+                    if (key_out) *key_out++ = key;
+                    if (stat_out)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, socks[i].inode );
+                        *stat_out++ = stat;
+                    }
+                }
+                num++;
+            }
+            free( socks );
+        }
+        else
+        {
+            if (!(fp = fopen( "/proc/net/udp", "r" )))
+            {
+                free( pid_map );
+                return ERROR_NOT_SUPPORTED;
+            }
 
-            if (num < *count)
+            /* skip header line */
+            ptr = fgets( buf, sizeof(buf), fp );
+            while ((ptr = fgets( buf, sizeof(buf), fp )))
             {
-                if (key_out) *key_out++ = key;
-                if (stat_out) *stat_out++ = stat;
+                if (sscanf( ptr, "%*u: %x:%hx %*s %*s %*s %*s %*s %*s %*s %d",
+                            &key.local.Ipv4.sin_addr.WS_s_addr, &key.local.Ipv4.sin_port, &inode ) != 3)
+                    continue;
+
+                key.local.Ipv4.sin_family = WS_AF_INET;
+                key.local.Ipv4.sin_port = htons( key.local.Ipv4.sin_port );
+
+                if (num < *count)
+                {
+                    if (key_out) *key_out++ = key;
+                    if (stat_out)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
+                        *stat_out++ = stat;
+                    }
+                }
+                num++;
             }
-            num++;
+            fclose( fp );
         }
-        fclose( fp );
 
-        if ((fp = fopen( "/proc/net/udp6", "r" )))
-        {
-            memset( &key, 0, sizeof(key) );
-            memset( &stat, 0, sizeof(stat) );
+        memset( &key, 0, sizeof(key) );
+        addr_scopes = get_ipv6_addr_scope_table( &addr_scopes_size );
 
-            addr_scopes = get_ipv6_addr_scope_table( &addr_scopes_size );
+        if ((socks = get_diag_sockets( AF_INET6, IPPROTO_UDP, ~0u, &socks_count )))
+        {
+            for (i = 0; i < socks_count; i++)
+            {
+                key.local.Ipv6.sin6_family = WS_AF_INET6;
+                memcpy( &key.local.Ipv6.sin6_addr, socks[i].local_addr, sizeof(key.local.Ipv6.sin6_addr) );
+                key.local.Ipv6.sin6_port = socks[i].local_port;
+                key.local.Ipv6.sin6_scope_id = find_ipv6_addr_scope( &key.local.Ipv6.sin6_addr, addr_scopes,
+                                                                     addr_scopes_size );
 
+                if (num < *count)
+                {
+                    if (key_out) *key_out++ = key;
+                    if (stat_out)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, socks[i].inode );
+                        *stat_out++ = stat;
+                    }
+                }
+                num++;
+            }
+            free( socks );
+        }
+        else if ((fp = fopen( "/proc/net/udp6", "r" )))
+        {
             /* skip header line */
             ptr = fgets( buf, sizeof(buf), fp );
             while ((ptr = fgets( buf, sizeof(buf), fp )))
@@ -283,15 +337,14 @@ static NTSTATUS udp_endpoint_enumerate_all( void *key_data, DWORD key_size, void
                 key.local.Ipv6.sin6_scope_id = find_ipv6_addr_scope( &key.local.Ipv6.sin6_addr, addr_scopes,
                                                                      addr_scopes_size );
 
-                stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
-                stat.create_time = 0; /* FIXME */
-                stat.flags = 0; /* FIXME */
-                stat.mod_info = 0; /* FIXME */
-
                 if (num < *count)
                 {
                     if (key_out) *key_out++ = key;
-                    if (stat_out) *stat_out++ = stat;
+                    if (stat_out)
+                    {
+                        stat.pid = find_owning_pid( pid_map, pid_map_size, inode );
+                        *stat_out++ = stat;
+                    }
                 }
                 num++;
             }
@@ -110,6 +110,19 @@ struct pid_map
 struct pid_map *get_pid_map( unsigned int *num_entries ) DECLSPEC_HIDDEN;
 unsigned int find_owning_pid( struct pid_map *map, unsigned int num_entries, UINT_PTR inode ) DECLSPEC_HIDDEN;
 
+struct diag_socket
+{
+    int state;
+    DWORD local_addr[4];
+    DWORD remote_addr[4];
+    USHORT local_port;  /* in network byte order */
+    USHORT remote_port;
+    UINT_PTR inode;
+};
+
+struct diag_socket *get_diag_sockets( int family, int protocol, unsigned int states,
+                                      unsigned int *count ) DECLSPEC_HIDDEN;
+
 struct module_table
 {
     DWORD table;
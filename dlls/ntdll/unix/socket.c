@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <poll.h>
 #ifdef HAVE_IFADDRS_H
 # include <ifaddrs.h>
 #endif
@@ -38,6 +39,9 @@
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 #ifdef HAVE_NETINET_IN_H
 # define __APPLE_USE_RFC_3542
 # include <netinet/in.h>
@@ -144,6 +148,7 @@ struct async_transmit_ioctl
     unsigned int buffer_cursor; /* amount of data currently in the buffer already sent */
     unsigned int tail_cursor;   /* amount of tail data already sent */
     unsigned int file_len;      /* total file length to send */
+    BOOL use_sendfile;          /* whether to try sending the file data with sendfile() */
     DWORD flags;
     TRANSMIT_FILE_BUFFERS buffers;
     LARGE_INTEGER offset;
@@ -676,6 +681,19 @@ static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
 }
 
 
+static void complete_async( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user,
+                            IO_STATUS_BLOCK *io, NTSTATUS status, ULONG_PTR information )
+{
+    ULONG_PTR iosb_ptr = iosb_client_ptr(io);
+
+    io->Status = status;
+    io->Information = information;
+    if (event) NtSetEvent( event, NULL );
+    if (apc) NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)apc, (ULONG_PTR)apc_user, iosb_ptr, 0 );
+    if (apc_user) add_completion( handle, (ULONG_PTR)apc_user, status, information, FALSE );
+}
+
+
 struct async_poll_ioctl
 {
     struct async_fileio io;
@@ -731,6 +749,140 @@ static BOOL async_poll_proc( void *user, ULONG_PTR *info, NTSTATUS *status )
 }
 
 
+/* Poll a single socket the same way the server does, using only the Unix fd.
+ * This is only done for listening and unconnected datagram sockets, whose state
+ * the server has already committed by the time the Unix socket reflects it.
+ * Returns -1 for any other socket, and whenever an error or hangup is pending,
+ * so that the server reports it and consumes the socket error itself. */
+static int poll_unix_socket( int fd, int mask, NTSTATUS *status )
+{
+    int type, listening = 0, oobinline = 0, flags = 0;
+    socklen_t len = sizeof(type);
+    union unix_sockaddr addr;
+    socklen_t addr_len = sizeof(addr);
+    struct pollfd pollfd;
+
+    if (getsockopt( fd, SOL_SOCKET, SO_TYPE, (char *)&type, &len ))
+        return -1;
+
+    if (type == SOCK_STREAM)
+    {
+#ifdef SO_ACCEPTCONN
+        len = sizeof(listening);
+        if (getsockopt( fd, SOL_SOCKET, SO_ACCEPTCONN, (char *)&listening, &len ) || !listening)
+            return -1;
+#else
+        return -1;
+#endif
+    }
+    else if (type == SOCK_DGRAM || type == SOCK_RAW)
+    {
+        /* connected datagram sockets also report AFD_POLL_CONNECT */
+        if (!getpeername( fd, &addr.addr, &addr_len ))
+            return -1;
+    }
+    else
+        return -1;
+
+    if (mask & AFD_POLL_OOB)
+    {
+        len = sizeof(oobinline);
+        if (getsockopt( fd, SOL_SOCKET, SO_OOBINLINE, (char *)&oobinline, &len ))
+            oobinline = 0;
+    }
+
+    pollfd.fd = fd;
+    pollfd.events = 0;
+    pollfd.revents = 0;
+    if (mask & (AFD_POLL_READ | AFD_POLL_ACCEPT))
+        pollfd.events |= POLLIN;
+    if (mask & AFD_POLL_OOB)
+        pollfd.events |= oobinline ? POLLIN : POLLPRI;
+    if (mask & AFD_POLL_WRITE)
+        pollfd.events |= POLLOUT;
+
+    if (poll( &pollfd, 1, 0 ) < 0)
+        return -1;
+
+    if (pollfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        return -1;
+
+    if (pollfd.revents & POLLIN)
+        flags |= listening ? AFD_POLL_ACCEPT : AFD_POLL_READ;
+    if (pollfd.revents & POLLPRI)
+        flags |= oobinline ? AFD_POLL_READ : AFD_POLL_OOB;
+    if (pollfd.revents & POLLOUT)
+        flags |= AFD_POLL_WRITE;
+
+    *status = STATUS_SUCCESS;
+    return flags & mask;
+}
+
+/* Try to satisfy a poll request without a server call. This is done if all
+ * sockets can be polled locally, and either the timeout is zero or some of
+ * the sockets are already signaled, in which case the server would complete
+ * the request immediately as well. Returns STATUS_PENDING otherwise. */
+static NTSTATUS try_poll_unix( const struct afd_poll_params *params, struct afd_poll_params *output,
+                               ULONG_PTR *information )
+{
+    struct poll_socket_output *results;
+    unsigned int i, count = 0;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    if (params->exclusive) return STATUS_PENDING;
+
+    if (!(results = calloc( params->count, sizeof(*results) )))
+        return STATUS_PENDING;
+
+    for (i = 0; i < params->count; ++i)
+    {
+        HANDLE handle = (HANDLE)params->sockets[i].socket;
+        int fd, needs_close, flags;
+        enum server_fd_type type;
+        NTSTATUS sock_status = STATUS_SUCCESS;
+
+        if (server_get_unix_fd( handle, 0, &fd, &needs_close, &type, NULL ))
+        {
+            status = STATUS_PENDING;
+            break;
+        }
+        flags = type == FD_TYPE_SOCKET ? poll_unix_socket( fd, params->sockets[i].flags, &sock_status ) : -1;
+        if (needs_close) close( fd );
+
+        if (flags < 0)
+        {
+            status = STATUS_PENDING;
+            break;
+        }
+        results[i].flags = flags;
+        results[i].status = sock_status;
+        if (flags) ++count;
+    }
+
+    if (!status && !count && params->timeout)
+        status = STATUS_PENDING;
+
+    if (!status)
+    {
+        /* the output buffer may alias the input one */
+        memmove( output, params, offsetof( struct afd_poll_params, sockets[0] ) );
+        count = 0;
+        for (i = 0; i < params->count; ++i)
+        {
+            if (!results[i].flags) continue;
+            output->sockets[count].socket = params->sockets[i].socket;
+            output->sockets[count].flags = results[i].flags;
+            output->sockets[count].status = results[i].status;
+            ++count;
+        }
+        output->count = count;
+        *information = offsetof( struct afd_poll_params, sockets[count] );
+    }
+
+    free( results );
+    return status;
+}
+
 /* we could handle this ioctl entirely on the server side, but the differing
  * structure size makes it painful */
 static NTSTATUS sock_poll( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user, IO_STATUS_BLOCK *io,
@@ -739,6 +891,7 @@ static NTSTATUS sock_poll( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
     const struct afd_poll_params *params = in_buffer;
     struct poll_socket_input *input;
     struct async_poll_ioctl *async;
+    ULONG_PTR information;
     HANDLE wait_handle;
     DWORD async_size;
     NTSTATUS status;
@@ -763,6 +916,13 @@ static NTSTATUS sock_poll( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
             FIXME( "unknown socket flags %#x\n", params->sockets[i].flags );
     }
 
+    if ((status = try_poll_unix( params, out_buffer, &information )) != STATUS_PENDING)
+    {
+        TRACE( "completed locally, %u sockets signaled\n", ((struct afd_poll_params *)out_buffer)->count );
+        complete_async( handle, event, apc, apc_user, io, status, information );
+        return status;
+    }
+
     if (!(input = malloc( params->count * sizeof(*input) )))
         return STATUS_NO_MEMORY;
 
@@ -1005,6 +1165,47 @@ static NTSTATUS try_transmit( int sock_fd, int file_fd, struct async_transmit_io
         async->file_cursor += ret;
     }
 
+#ifdef HAVE_SYS_SENDFILE_H
+    /* let the kernel copy the file data directly to the socket when possible */
+    while (async->file && async->use_sendfile && async->buffer_cursor == async->read_len)
+    {
+        size_t count = 0x7ffff000;
+
+        if (async->file_len)
+            count = min( count, async->file_len - async->file_cursor );
+
+        TRACE( "sending up to %zu bytes of file data with sendfile\n", count );
+        if (async->offset.QuadPart == FILE_USE_FILE_POINTER_POSITION)
+            ret = sendfile( sock_fd, file_fd, NULL, count );
+        else
+        {
+            off_t offset = async->offset.QuadPart;
+            ret = sendfile( sock_fd, file_fd, &offset, count );
+        }
+        if (ret < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)
+            {
+                /* fall back to the buffered path */
+                TRACE( "sendfile failed: %s\n", strerror( errno ));
+                async->use_sendfile = FALSE;
+                break;
+            }
+            if (errno != EWOULDBLOCK) WARN( "sendfile: %s\n", strerror( errno ));
+            return sock_errno_to_status( errno );
+        }
+        TRACE( "sendfile returned %zd\n", ret );
+
+        async->file_cursor += ret;
+        if (async->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            async->offset.QuadPart += ret;
+
+        if (!ret || (async->file_len && async->file_cursor == async->file_len))
+            async->file = NULL;
+    }
+#endif
+
     if (async->file && async->buffer_cursor == async->read_len)
     {
         unsigned int read_size = async->buffer_size;
@@ -1123,6 +1324,7 @@ static NTSTATUS sock_transmit( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc,
     async->buffer_cursor = 0;
     async->tail_cursor = 0;
     async->file_len = params->file_len;
+    async->use_sendfile = TRUE;
     async->flags = params->flags;
     async->buffers = params->buffers;
     async->offset = params->offset;
@@ -1148,19 +1350,6 @@ static NTSTATUS sock_transmit( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc,
     return status;
 }
 
-static void complete_async( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user,
-                            IO_STATUS_BLOCK *io, NTSTATUS status, ULONG_PTR information )
-{
-    ULONG_PTR iosb_ptr = iosb_client_ptr(io);
-
-    io->Status = status;
-    io->Information = information;
-    if (event) NtSetEvent( event, NULL );
-    if (apc) NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)apc, (ULONG_PTR)apc_user, iosb_ptr, 0 );
-    if (apc_user) add_completion( handle, (ULONG_PTR)apc_user, status, information, FALSE );
-}
-
-
 static NTSTATUS do_getsockopt( HANDLE handle, IO_STATUS_BLOCK *io, int level,
                                int option, void *out_buffer, ULONG out_size )
 {
@@ -125,6 +125,7 @@ struct work_item
     IUnknown IUnknown_iface;
     LONG refcount;
     struct list entry;
+    struct list ready_entry;
     IRtwqAsyncResult *result;
     IRtwqAsyncResult *reply_result;
     struct queue *queue;
@@ -177,6 +178,17 @@ struct queue
     CRITICAL_SECTION cs;
     struct list pending_items;
     DWORD id;
+    /* Data used for pool queues only. Items are dispatched through a single work object,
+       each callback runs queued items in priority order until none are left. */
+    TP_WORK *work_object;
+    SRWLOCK ready_lock;
+    struct list ready_items[ARRAY_SIZE(priorities)];
+    struct
+    {
+        WCHAR *class;
+        DWORD taskid;
+        LONG priority;
+    } mmcss;
     /* Data used for serial queues only. */
     PTP_SIMPLE_CALLBACK finalization_callback;
     DWORD target_queue;
@@ -309,12 +321,15 @@ static void CALLBACK standard_queue_cleanup_callback(void *object_data, void *gr
 {
 }
 
+static void CALLBACK pool_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work);
+
 static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queue)
 {
     TP_CALLBACK_ENVIRON_V3 env;
     unsigned int max_thread, i;
 
-    queue->pool = CreateThreadpool(NULL);
+    if (!(queue->pool = CreateThreadpool(NULL)))
+        return HRESULT_FROM_WIN32(GetLastError());
 
     memset(&env, 0, sizeof(env));
     env.Version = 3;
@@ -330,6 +345,21 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
     }
     list_init(&queue->pending_items);
     InitializeCriticalSection(&queue->cs);
+    InitializeSRWLock(&queue->ready_lock);
+    for (i = 0; i < ARRAY_SIZE(queue->ready_items); ++i)
+        list_init(&queue->ready_items[i]);
+    if (!(queue->work_object = CreateThreadpoolWork(pool_queue_worker, queue,
+            (TP_CALLBACK_ENVIRON *)&queue->envs[TP_CALLBACK_PRIORITY_NORMAL])))
+    {
+        HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+
+        WARN("Failed to create work object, hr %#x.\n", hr);
+        DeleteCriticalSection(&queue->cs);
+        CloseThreadpoolCleanupGroup(env.CleanupGroup);
+        CloseThreadpool(queue->pool);
+        queue->pool = NULL;
+        return hr;
+    }
 
     max_thread = (desc->queue_type == RTWQ_STANDARD_WORKQUEUE || desc->queue_type == RTWQ_WINDOW_WORKQUEUE) ? 1 : 4;
 
@@ -344,6 +374,9 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
 
 static BOOL pool_queue_shutdown(struct queue *queue)
 {
+    struct work_item *item, *next;
+    unsigned int i;
+
     if (!queue->pool)
         return FALSE;
 
@@ -351,30 +384,102 @@ static BOOL pool_queue_shutdown(struct queue *queue)
     CloseThreadpool(queue->pool);
     queue->pool = NULL;
 
+    /* Callbacks were cancelled, release items that were never dispatched. */
+    for (i = 0; i < ARRAY_SIZE(queue->ready_items); ++i)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE(item, next, &queue->ready_items[i], struct work_item, ready_entry)
+        {
+            list_remove(&item->ready_entry);
+            if (item->finalization_callback)
+                IUnknown_Release(&item->IUnknown_iface);
+            IUnknown_Release(&item->IUnknown_iface);
+        }
+    }
+
     return TRUE;
 }
 
-static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+static struct work_item *pool_queue_get_next(struct queue *queue)
 {
-    struct work_item *item = context;
-    RTWQASYNCRESULT *result = (RTWQASYNCRESULT *)item->result;
+    struct work_item *item = NULL;
+    struct list *head;
+    unsigned int i;
 
-    TRACE("result object %p.\n", result);
+    AcquireSRWLockExclusive(&queue->ready_lock);
+    for (i = 0; i < ARRAY_SIZE(queue->ready_items); ++i)
+    {
+        if ((head = list_head(&queue->ready_items[i])))
+        {
+            item = LIST_ENTRY(head, struct work_item, ready_entry);
+            list_remove(&item->ready_entry);
+            break;
+        }
+    }
+    ReleaseSRWLockExclusive(&queue->ready_lock);
 
-    /* Submitting from serial queue in reply mode, use different result object acting as receipt token.
-       It's submitted to user callback still, but when invoked, special serial queue callback will be used
-       to ensure correct destination queue. */
+    return item;
+}
 
-    IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
+static int get_mmcss_thread_priority(LONG priority)
+{
+    /* AVRT_PRIORITY values, from low to critical. */
+    if (priority >= 2)
+        return THREAD_PRIORITY_TIME_CRITICAL;
+    if (priority == 1)
+        return THREAD_PRIORITY_HIGHEST;
+    return THREAD_PRIORITY_ABOVE_NORMAL;
+}
 
-    IUnknown_Release(&item->IUnknown_iface);
+static void CALLBACK pool_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    struct queue *queue = context;
+    RTWQASYNCRESULT *result;
+    struct work_item *item;
+    BOOL elevated = FALSE;
+    LONG priority;
+    BOOL mmcss;
+
+    /* Work object was created before RtwqSetLongRunning() could have been called. */
+    if (queue->envs[TP_CALLBACK_PRIORITY_NORMAL].u.s.LongFunction)
+        CallbackMayRunLong(instance);
+
+    /* Items submitted since the previous callback started are picked up here too,
+       callbacks that find nothing left to do return immediately. */
+    while ((item = pool_queue_get_next(queue)))
+    {
+        result = (RTWQASYNCRESULT *)item->result;
+
+        TRACE("result object %p.\n", result);
+
+        if (!elevated)
+        {
+            EnterCriticalSection(&queue->cs);
+            mmcss = !!queue->mmcss.class;
+            priority = queue->mmcss.priority;
+            LeaveCriticalSection(&queue->cs);
+
+            if (mmcss)
+                elevated = SetThreadPriority(GetCurrentThread(), get_mmcss_thread_priority(priority));
+        }
+
+        /* Submitting from serial queue in reply mode, use different result object acting as receipt token.
+           It's submitted to user callback still, but when invoked, special serial queue callback will be used
+           to ensure correct destination queue. */
+
+        IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
+
+        IUnknown_Release(&item->IUnknown_iface);
+        if (item->finalization_callback)
+            item->finalization_callback(instance, item);
+    }
+
+    if (elevated)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
 }
 
 static void pool_queue_submit(struct queue *queue, struct work_item *item)
 {
     TP_CALLBACK_PRIORITY callback_priority;
-    TP_CALLBACK_ENVIRON_V3 env;
-    TP_WORK *work_object;
 
     if (item->priority == 0)
         callback_priority = TP_CALLBACK_PRIORITY_NORMAL;
@@ -383,14 +488,16 @@ static void pool_queue_submit(struct queue *queue, struct work_item *item)
     else
         callback_priority = TP_CALLBACK_PRIORITY_HIGH;
 
-    env = queue->envs[callback_priority];
-    env.FinalizationCallback = item->finalization_callback;
-    /* Worker pool callback will release one reference. Grab one more to keep object alive when
+    /* Worker callback will release one reference. Grab one more to keep object alive when
        we need finalization callback. */
     if (item->finalization_callback)
         IUnknown_AddRef(&item->IUnknown_iface);
-    work_object = CreateThreadpoolWork(standard_queue_worker, item, (TP_CALLBACK_ENVIRON *)&env);
-    SubmitThreadpoolWork(work_object);
+
+    AcquireSRWLockExclusive(&queue->ready_lock);
+    list_add_tail(&queue->ready_items[callback_priority], &item->ready_entry);
+    ReleaseSRWLockExclusive(&queue->ready_lock);
+
+    SubmitThreadpoolWork(queue->work_object);
 
     TRACE("dispatched %p.\n", item->result);
 }
@@ -581,6 +688,7 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     item->refcount = 1;
     item->queue = queue;
     list_init(&item->entry);
+    list_init(&item->ready_entry);
     item->priority = priority;
 
     if (SUCCEEDED(IRtwqAsyncCallback_GetParameters(async_result->pCallback, &flags, &queue_id)))
@@ -589,16 +697,22 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     return item;
 }
 
-static void init_work_queue(const struct queue_desc *desc, struct queue *queue)
+static HRESULT init_work_queue(const struct queue_desc *desc, struct queue *queue)
 {
+    HRESULT hr;
+
     assert(desc->ops != NULL);
 
     queue->ops = desc->ops;
-    if (SUCCEEDED(queue->ops->init(desc, queue)))
+    if (SUCCEEDED(hr = queue->ops->init(desc, queue)))
     {
         list_init(&queue->pending_items);
         InitializeCriticalSection(&queue->cs);
     }
+    else
+        queue->ops = NULL;
+
+    return hr;
 }
 
 static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
@@ -606,6 +720,7 @@ static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
     struct queue *queue = get_system_queue(queue_id);
     RTWQ_WORKQUEUE_TYPE queue_type;
     struct queue_handle *entry;
+    HRESULT hr;
 
     *ret = NULL;
 
@@ -636,8 +751,10 @@ static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
         desc.queue_type = queue_type;
         desc.ops = &pool_queue_ops;
         desc.target_queue = 0;
-        init_work_queue(&desc, queue);
+        hr = init_work_queue(&desc, queue);
         LeaveCriticalSection(&queues_section);
+        if (FAILED(hr))
+            return hr;
         *ret = queue;
         return S_OK;
     }
@@ -665,6 +782,7 @@ static void shutdown_queue(struct queue *queue)
     LeaveCriticalSection(&queue->cs);
 
     DeleteCriticalSection(&queue->cs);
+    free(queue->mmcss.class);
 
     memset(queue, 0, sizeof(*queue));
 }
@@ -891,6 +1009,7 @@ static HRESULT alloc_user_queue(const struct queue_desc *desc, DWORD *queue_id)
     struct queue_handle *entry;
     struct queue *queue;
     unsigned int idx;
+    HRESULT hr;
 
     *queue_id = RTWQ_CALLBACK_QUEUE_UNDEFINED;
 
@@ -900,7 +1019,11 @@ static HRESULT alloc_user_queue(const struct queue_desc *desc, DWORD *queue_id)
     if (!(queue = calloc(1, sizeof(*queue))))
         return E_OUTOFMEMORY;
 
-    init_work_queue(desc, queue);
+    if (FAILED(hr = init_work_queue(desc, queue)))
+    {
+        free(queue);
+        return hr;
+    }
 
     EnterCriticalSection(&queues_section);
 
@@ -1139,7 +1262,8 @@ static void init_system_queues(void)
     desc.queue_type = RTWQ_STANDARD_WORKQUEUE;
     desc.ops = &pool_queue_ops;
     desc.target_queue = 0;
-    init_work_queue(&desc, &system_queues[SYS_QUEUE_STANDARD]);
+    if (FAILED(hr = init_work_queue(&desc, &system_queues[SYS_QUEUE_STANDARD])))
+        WARN("Failed to initialize standard queue, hr %#x.\n", hr);
 
     LeaveCriticalSection(&queues_section);
 }
@@ -1516,25 +1640,102 @@ HRESULT WINAPI RtwqUnjoinWorkQueue(DWORD queue, HANDLE cookie)
     return E_NOTIMPL;
 }
 
-HRESULT WINAPI RtwqGetWorkQueueMMCSSClass(DWORD queue, WCHAR *class, DWORD *length)
+static LONG next_mmcss_taskid;
+
+static HRESULT queue_set_mmcss(DWORD queue_id, const WCHAR *class, DWORD *taskid, LONG priority)
 {
-    FIXME("%#x, %p, %p.\n", queue, class, length);
+    struct queue *queue;
+    WCHAR *new_class = NULL;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    if (FAILED(hr = grab_queue(queue_id, &queue)))
+        return hr;
+
+    if (class && !(new_class = wcsdup(class)))
+        return E_OUTOFMEMORY;
+
+    EnterCriticalSection(&queue->cs);
+    free(queue->mmcss.class);
+    queue->mmcss.class = new_class;
+    if (new_class)
+    {
+        if (!*taskid)
+            *taskid = InterlockedIncrement(&next_mmcss_taskid);
+        queue->mmcss.taskid = *taskid;
+        queue->mmcss.priority = priority;
+    }
+    else
+    {
+        queue->mmcss.taskid = 0;
+        queue->mmcss.priority = 0;
+    }
+    LeaveCriticalSection(&queue->cs);
+
+    return S_OK;
 }
 
-HRESULT WINAPI RtwqGetWorkQueueMMCSSTaskId(DWORD queue, DWORD *taskid)
+HRESULT WINAPI RtwqGetWorkQueueMMCSSClass(DWORD queue_id, WCHAR *class, DWORD *length)
 {
-    FIXME("%#x, %p.\n", queue, taskid);
+    struct queue *queue;
+    DWORD size;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("%#x, %p, %p.\n", queue_id, class, length);
+
+    if (!length)
+        return E_POINTER;
+
+    if (FAILED(hr = grab_queue(queue_id, &queue)))
+        return hr;
+
+    EnterCriticalSection(&queue->cs);
+    size = queue->mmcss.class ? wcslen(queue->mmcss.class) + 1 : 1;
+    if (!class || *length < size)
+        hr = HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+    else if (queue->mmcss.class)
+        memcpy(class, queue->mmcss.class, size * sizeof(WCHAR));
+    else
+        *class = 0;
+    *length = size;
+    LeaveCriticalSection(&queue->cs);
+
+    return hr;
 }
 
-HRESULT WINAPI RtwqGetWorkQueueMMCSSPriority(DWORD queue, LONG *priority)
+HRESULT WINAPI RtwqGetWorkQueueMMCSSTaskId(DWORD queue_id, DWORD *taskid)
 {
-    FIXME("%#x, %p.\n", queue, priority);
+    struct queue *queue;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("%#x, %p.\n", queue_id, taskid);
+
+    if (!taskid)
+        return E_POINTER;
+
+    if (FAILED(hr = grab_queue(queue_id, &queue)))
+        return hr;
+
+    *taskid = queue->mmcss.taskid;
+
+    return S_OK;
+}
+
+HRESULT WINAPI RtwqGetWorkQueueMMCSSPriority(DWORD queue_id, LONG *priority)
+{
+    struct queue *queue;
+    HRESULT hr;
+
+    TRACE("%#x, %p.\n", queue_id, priority);
+
+    if (!priority)
+        return E_POINTER;
+
+    if (FAILED(hr = grab_queue(queue_id, &queue)))
+        return hr;
+
+    *priority = queue->mmcss.priority;
+
+    return S_OK;
 }
 
 HRESULT WINAPI RtwqRegisterPlatformWithMMCSS(const WCHAR *class, DWORD *taskid, LONG priority)
@@ -1554,30 +1755,69 @@ HRESULT WINAPI RtwqUnregisterPlatformFromMMCSS(void)
 HRESULT WINAPI RtwqBeginRegisterWorkQueueWithMMCSS(DWORD queue, const WCHAR *class, DWORD taskid, LONG priority,
         IRtwqAsyncCallback *callback, IUnknown *state)
 {
-    FIXME("%#x, %s, %u, %d, %p, %p.\n", queue, debugstr_w(class), taskid, priority, callback, state);
+    IRtwqAsyncResult *result;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("%#x, %s, %u, %d, %p, %p.\n", queue, debugstr_w(class), taskid, priority, callback, state);
+
+    if (!class)
+        return E_POINTER;
+
+    /* There is no MMCSS service, items of registered queues run at raised thread priority instead. */
+    if (FAILED(hr = queue_set_mmcss(queue, class, &taskid, priority)))
+        return hr;
+
+    if (FAILED(hr = create_async_result(NULL, callback, state, &result)))
+        return hr;
+
+    /* Task id is returned by RtwqEndRegisterWorkQueueWithMMCSS(). */
+    ((RTWQASYNCRESULT *)result)->dwBytesTransferred = taskid;
+    hr = RtwqInvokeCallback(result);
+    IRtwqAsyncResult_Release(result);
+
+    return hr;
 }
 
 HRESULT WINAPI RtwqEndRegisterWorkQueueWithMMCSS(IRtwqAsyncResult *result, DWORD *taskid)
 {
-    FIXME("%p, %p.\n", result, taskid);
+    TRACE("%p, %p.\n", result, taskid);
 
-    return E_NOTIMPL;
+    if (!result || !taskid)
+        return E_POINTER;
+
+    *taskid = ((RTWQASYNCRESULT *)result)->dwBytesTransferred;
+
+    return IRtwqAsyncResult_GetStatus(result);
 }
 
 HRESULT WINAPI RtwqBeginUnregisterWorkQueueWithMMCSS(DWORD queue, IRtwqAsyncCallback *callback, IUnknown *state)
 {
-    FIXME("%#x, %p, %p.\n", queue, callback, state);
+    IRtwqAsyncResult *result;
+    DWORD taskid = 0;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("%#x, %p, %p.\n", queue, callback, state);
+
+    if (FAILED(hr = queue_set_mmcss(queue, NULL, &taskid, 0)))
+        return hr;
+
+    if (FAILED(hr = create_async_result(NULL, callback, state, &result)))
+        return hr;
+
+    hr = RtwqInvokeCallback(result);
+    IRtwqAsyncResult_Release(result);
+
+    return hr;
 }
 
 HRESULT WINAPI RtwqEndUnregisterWorkQueueWithMMCSS(IRtwqAsyncResult *result)
 {
-    FIXME("%p.\n", result);
+    TRACE("%p.\n", result);
 
-    return E_NOTIMPL;
+    if (!result)
+        return E_POINTER;
+
+    return IRtwqAsyncResult_GetStatus(result);
 }
 
 HRESULT WINAPI RtwqRegisterPlatformEvents(IRtwqPlatformEvents *events)
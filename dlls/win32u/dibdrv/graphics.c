@@ -24,12 +24,15 @@
 
 #include <assert.h>
 #include <pthread.h>
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
 #include "ntgdi_private.h"
 #include "dibdrv.h"
 
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
+WINE_DECLARE_DEBUG_CHANNEL(glyphcache);
 
 struct cached_glyph
 {
@@ -55,6 +58,8 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    ULONGLONG             shared_key;  /* key in the shared glyph cache, 0 if not shareable */
+    LONG                  shared_key_init;
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
@@ -567,6 +572,8 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
     }
     font.lf.lfWidth = abs( font.lf.lfWidth );
     font.aa_flags = aa_flags;
+    font.shared_key = 0;
+    font.shared_key_init = FALSE;
     font.hash = font_cache_hash( &font );
 
     pthread_mutex_lock( &font_cache_lock );
@@ -657,6 +664,371 @@ static struct cached_glyph *get_cached_glyph( struct cached_font *font, UINT ind
     return font->glyphs[type][page][index % GLYPH_CACHE_PAGE_SIZE];
 }
 
+/* shared glyph cache
+ *
+ * When enabled, rasterized glyphs are also stored in a named section so that other
+ * processes drawing the same text don't need to go through FreeType again. The data
+ * area is split in segments that are filled one after the other; once they are all
+ * in use, the least recently used segment is emptied and reused. Glyphs are keyed by
+ * a hash of the cached_font key and of the file the font was realized from, and are
+ * copied to the local glyph cache on a hit.
+ *
+ * Updates are serialized by a named mutex, but lookups don't take it: writers make
+ * the sequence count odd while they modify the cache, and readers discard what they
+ * copied if the count was odd or changed in the meantime.
+ */
+
+#define SHARED_GLYPH_MAGIC     0x32504c47  /* "GLP2" */
+#define SHARED_GLYPH_BUCKETS   4096
+#define SHARED_GLYPH_SEGMENTS  16
+
+struct shared_glyph
+{
+    ULONGLONG    font;  /* hash of the font key */
+    UINT         next;  /* offset of the next glyph in the bucket, 0 if none */
+    UINT         size;
+    UINT         index;
+    UINT         type;
+    GLYPHMETRICS metrics;
+    BYTE         bits[1];
+};
+
+struct shared_glyph_segment
+{
+    UINT used;
+    UINT last_used;
+};
+
+struct shared_glyph_cache
+{
+    UINT                        magic;
+    UINT                        size;
+    UINT                        data_start;
+    UINT                        segment_size;
+    UINT                        current;
+    LONG                        sequence;
+    LONG                        clock;
+    LONG                        lookups;
+    LONG                        hits;
+    UINT                        evictions;
+    struct shared_glyph_segment segments[SHARED_GLYPH_SEGMENTS];
+    UINT                        buckets[SHARED_GLYPH_BUCKETS];
+};
+
+struct shared_font_key
+{
+    LOGFONTW      lf;
+    XFORM         xform;
+    UINT          aa_flags;
+    UINT          face_index;
+    FILETIME      writetime;
+    LARGE_INTEGER file_size;
+    WCHAR         path[MAX_PATH];
+};
+
+static UINT shared_glyph_cache_size;
+static struct shared_glyph_cache *shared_glyph_cache;
+static SIZE_T shared_glyph_view_size;
+static HANDLE shared_glyph_mutex;
+static pthread_once_t shared_glyph_once = PTHREAD_ONCE_INIT;
+
+void set_shared_glyph_cache_size( UINT size )
+{
+    shared_glyph_cache_size = size;
+}
+
+#define SHARED_GLYPH_DATA_START ((sizeof(struct shared_glyph_cache) + 7) & ~7)
+
+/* must be called with the mutex held, around any change readers may see */
+static inline void begin_shared_glyph_update( struct shared_glyph_cache *cache )
+{
+    InterlockedIncrement( &cache->sequence );
+}
+
+static inline void end_shared_glyph_update( struct shared_glyph_cache *cache )
+{
+    InterlockedIncrement( &cache->sequence );
+}
+
+static void reset_shared_glyph_cache( struct shared_glyph_cache *cache )
+{
+    /* the count is left odd if a writer died in the middle of an update */
+    if (!(cache->sequence & 1)) begin_shared_glyph_update( cache );
+    cache->data_start = SHARED_GLYPH_DATA_START;
+    cache->segment_size = ((cache->size - cache->data_start) / SHARED_GLYPH_SEGMENTS) & ~7;
+    cache->current = 0;
+    cache->clock = 0;
+    memset( cache->segments, 0, sizeof(cache->segments) );
+    memset( cache->buckets, 0, sizeof(cache->buckets) );
+    cache->magic = SHARED_GLYPH_MAGIC;
+    end_shared_glyph_update( cache );
+}
+
+static BOOL lock_shared_glyph_cache(void)
+{
+    NTSTATUS status = NtWaitForSingleObject( shared_glyph_mutex, FALSE, NULL );
+
+    if (status == STATUS_ABANDONED)
+    {
+        WARN( "previous owner died, resetting shared glyph cache\n" );
+        reset_shared_glyph_cache( shared_glyph_cache );
+        return TRUE;
+    }
+    return !status;
+}
+
+static void unlock_shared_glyph_cache(void)
+{
+    NtReleaseMutant( shared_glyph_mutex, NULL );
+}
+
+static void init_shared_glyph_cache(void)
+{
+    static WCHAR sectionW[] = {'\\','B','a','s','e','N','a','m','e','d','O','b','j','e','c','t','s',
+                               '\\','_','_','w','i','n','e','_','g','l','y','p','h','_','c','a','c','h','e'};
+    static WCHAR mutexW[] = {'\\','B','a','s','e','N','a','m','e','d','O','b','j','e','c','t','s',
+                             '\\','_','_','w','i','n','e','_','g','l','y','p','h','_','m','u','t','e','x'};
+    OBJECT_ATTRIBUTES attr = { sizeof(attr) };
+    UNICODE_STRING name;
+    LARGE_INTEGER size;
+    struct shared_glyph_cache *cache = NULL;
+    SIZE_T view_size = 0;
+    HANDLE section;
+
+    if (!shared_glyph_cache_size) return;
+
+    attr.Attributes = OBJ_OPENIF;
+    attr.ObjectName = &name;
+    name.Buffer = mutexW;
+    name.Length = name.MaximumLength = sizeof(mutexW);
+    if (NtCreateMutant( &shared_glyph_mutex, MUTEX_ALL_ACCESS, &attr, FALSE ) < 0) return;
+
+    name.Buffer = sectionW;
+    name.Length = name.MaximumLength = sizeof(sectionW);
+    size.QuadPart = shared_glyph_cache_size;
+    if (NtCreateSection( &section, SECTION_ALL_ACCESS, &attr, &size, PAGE_READWRITE, SEC_COMMIT, 0 ) < 0)
+        goto failed;
+    if (NtMapViewOfSection( section, GetCurrentProcess(), (void **)&cache, 0, 0, NULL,
+                            &view_size, ViewShare, 0, PAGE_READWRITE ))
+    {
+        NtClose( section );
+        goto failed;
+    }
+    NtClose( section );
+
+    if (lock_shared_glyph_cache())
+    {
+        /* the section may have been created by a process using a different size */
+        if (cache->magic != SHARED_GLYPH_MAGIC || cache->size > view_size ||
+            cache->data_start != SHARED_GLYPH_DATA_START)
+        {
+            cache->size = min( view_size, shared_glyph_cache_size );
+            reset_shared_glyph_cache( cache );
+        }
+        unlock_shared_glyph_cache();
+        if (cache->segment_size >= 4096)
+        {
+            TRACE( "using shared glyph cache %p, size %u\n", cache, cache->size );
+            shared_glyph_view_size = view_size;
+            shared_glyph_cache = cache;
+            return;
+        }
+    }
+    NtUnmapViewOfSection( GetCurrentProcess(), cache );
+
+failed:
+    WARN( "shared glyph cache disabled\n" );
+    NtClose( shared_glyph_mutex );
+    shared_glyph_mutex = 0;
+}
+
+static ULONGLONG hash_shared_font_key( const struct shared_font_key *key )
+{
+    const BYTE *ptr = (const BYTE *)key;
+    ULONGLONG hash = 0xcbf29ce484222325;  /* FNV-1a */
+    UINT i;
+
+    for (i = 0; i < sizeof(*key); i++) hash = (hash ^ ptr[i]) * 0x100000001b3;
+    return hash ? hash : 1;
+}
+
+/* compute the key identifying the glyphs of a font in the shared cache */
+static ULONGLONG get_shared_font_key( DC *dc, const struct cached_font *font )
+{
+    char buffer[FIELD_OFFSET( struct font_fileinfo, path[MAX_PATH] )];
+    struct font_fileinfo *file_info = (struct font_fileinfo *)buffer;
+    struct font_realization_info info;
+    struct shared_font_key key;
+    UINT i;
+
+    info.size = sizeof(info);
+    if (!NtGdiGetRealizationInfo( dc->hSelf, &info )) return 0;
+    if (!NtGdiGetFontFileInfo( info.instance_id, 0, file_info, sizeof(buffer), NULL )) return 0;
+    if (!file_info->path[0]) return 0;  /* memory fonts are private to the process */
+
+    memset( &key, 0, sizeof(key) );
+    key.lf = font->lf;
+    memset( key.lf.lfFaceName, 0, sizeof(key.lf.lfFaceName) );
+    for (i = 0; i < LF_FACESIZE - 1 && font->lf.lfFaceName[i]; i++)
+        key.lf.lfFaceName[i] = towupper( font->lf.lfFaceName[i] );
+    key.xform      = font->xform;
+    key.aa_flags   = font->aa_flags;
+    key.face_index = info.face_index;
+    key.writetime  = file_info->writetime;
+    key.file_size  = file_info->size;
+    lstrcpynW( key.path, file_info->path, MAX_PATH );
+    return hash_shared_font_key( &key );
+}
+
+static inline UINT shared_glyph_bucket( ULONGLONG font, UINT index, enum glyph_type type )
+{
+    return (UINT)(font ^ (font >> 32) ^ (index * 0x9e3779b1) ^ type) % SHARED_GLYPH_BUCKETS;
+}
+
+/* the header may be modified by other processes, so only trust our own view size */
+static inline struct shared_glyph *get_shared_glyph( struct shared_glyph_cache *cache, UINT offset )
+{
+    if (offset < SHARED_GLYPH_DATA_START || offset > shared_glyph_view_size - sizeof(struct shared_glyph) ||
+        offset % 8)
+        return NULL;
+    return (struct shared_glyph *)((char *)cache + offset);
+}
+
+static inline UINT read_shared_uint( const UINT *ptr )
+{
+    return *(volatile const UINT *)ptr;
+}
+
+static void dump_shared_glyph_cache_stats( struct shared_glyph_cache *cache )
+{
+    UINT i, used = 0;
+
+    if (!TRACE_ON(glyphcache) || cache->lookups % 4096) return;
+    for (i = 0; i < SHARED_GLYPH_SEGMENTS; i++) used += cache->segments[i].used;
+    TRACE_(glyphcache)( "%u lookups, %u%% hits, %u segment evictions, %u/%u KB used\n",
+                        (UINT)cache->lookups, (UINT)((ULONGLONG)(UINT)cache->hits * 100 / (UINT)cache->lookups),
+                        cache->evictions,
+                        used / 1024, cache->segment_size * SHARED_GLYPH_SEGMENTS / 1024 );
+}
+
+static struct cached_glyph *find_shared_glyph( struct cached_font *font, UINT index, UINT flags )
+{
+    struct shared_glyph_cache *cache = shared_glyph_cache;
+    enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
+    struct cached_glyph *ret = NULL;
+    struct shared_glyph *glyph;
+    UINT offset, size, segment, count = 0;
+    LONG sequence;
+
+    InterlockedIncrement( &cache->lookups );
+    dump_shared_glyph_cache_stats( cache );
+
+    sequence = *(volatile LONG *)&cache->sequence;
+    if (sequence & 1) return NULL;  /* being updated, render the glyph ourselves */
+    MemoryBarrier();
+
+    offset = read_shared_uint( &cache->buckets[shared_glyph_bucket( font->shared_key, index, type )] );
+    while ((glyph = get_shared_glyph( cache, offset )) && count++ < 1024)
+    {
+        if (glyph->font == font->shared_key && glyph->index == index && glyph->type == type)
+        {
+            size = read_shared_uint( &glyph->size );
+            if (size < FIELD_OFFSET( struct shared_glyph, bits ) || size > shared_glyph_view_size - offset)
+                return NULL;
+            size -= FIELD_OFFSET( struct shared_glyph, bits );
+
+            if ((ret = malloc( FIELD_OFFSET( struct cached_glyph, bits[size] ))))
+            {
+                ret->metrics = glyph->metrics;
+                memcpy( ret->bits, glyph->bits, size );
+            }
+            break;
+        }
+        offset = read_shared_uint( &glyph->next );
+    }
+    if (!ret) return NULL;
+
+    MemoryBarrier();
+    if (*(volatile LONG *)&cache->sequence != sequence)
+    {
+        free( ret );
+        return NULL;
+    }
+
+    /* only a hint for the eviction, no need to hold the mutex */
+    if ((size = read_shared_uint( &cache->segment_size )) &&
+        (segment = (offset - SHARED_GLYPH_DATA_START) / size) < SHARED_GLYPH_SEGMENTS)
+        cache->segments[segment].last_used = InterlockedIncrement( &cache->clock );
+    InterlockedIncrement( &cache->hits );
+    return ret;
+}
+
+static void evict_shared_glyph_segment( struct shared_glyph_cache *cache, UINT segment )
+{
+    UINT start = cache->data_start + segment * cache->segment_size;
+    UINT offset, *next;
+    struct shared_glyph *glyph, *iter;
+
+    for (offset = start; offset < start + cache->segments[segment].used; offset += glyph->size)
+    {
+        if (!(glyph = get_shared_glyph( cache, offset )) || !glyph->size) break;
+        next = &cache->buckets[shared_glyph_bucket( glyph->font, glyph->index, glyph->type )];
+        while ((iter = get_shared_glyph( cache, *next )))
+        {
+            if (*next == offset)
+            {
+                *next = iter->next;
+                break;
+            }
+            next = &iter->next;
+        }
+    }
+    cache->segments[segment].used = 0;
+    cache->evictions++;
+}
+
+static void add_shared_glyph( struct cached_font *font, UINT index, UINT flags,
+                              const struct cached_glyph *glyph, UINT bits_size )
+{
+    struct shared_glyph_cache *cache = shared_glyph_cache;
+    enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
+    UINT i, size, offset, bucket;
+    struct shared_glyph *entry;
+
+    size = (FIELD_OFFSET( struct shared_glyph, bits[bits_size] ) + 7) & ~7;
+    if (size > cache->segment_size / 16) return;  /* don't let large glyphs flush the cache */
+
+    if (!lock_shared_glyph_cache()) return;
+    begin_shared_glyph_update( cache );
+
+    if (cache->segments[cache->current].used + size > cache->segment_size)
+    {
+        UINT oldest = 0;
+
+        for (i = 1; i < SHARED_GLYPH_SEGMENTS; i++)
+            if (cache->segments[i].last_used < cache->segments[oldest].last_used) oldest = i;
+        if (cache->segments[oldest].used) evict_shared_glyph_segment( cache, oldest );
+        cache->current = oldest;
+    }
+
+    offset = cache->data_start + cache->current * cache->segment_size + cache->segments[cache->current].used;
+    entry = (struct shared_glyph *)((char *)cache + offset);
+    bucket = shared_glyph_bucket( font->shared_key, index, type );
+    entry->font    = font->shared_key;
+    entry->size    = size;
+    entry->index   = index;
+    entry->type    = type;
+    entry->metrics = glyph->metrics;
+    memcpy( entry->bits, glyph->bits, bits_size );
+    entry->next    = cache->buckets[bucket];
+    cache->buckets[bucket] = offset;
+    cache->segments[cache->current].used += size;
+    cache->segments[cache->current].last_used = InterlockedIncrement( &cache->clock );
+
+    end_shared_glyph_update( cache );
+    unlock_shared_glyph_cache();
+}
+
 /**********************************************************************
  *                 get_text_bkgnd_masks
  *
@@ -754,6 +1126,19 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
     GLYPHMETRICS metrics;
     struct cached_glyph *glyph;
 
+    if (shared_glyph_cache_size) pthread_once( &shared_glyph_once, init_shared_glyph_cache );
+    if (shared_glyph_cache)
+    {
+        if (!InterlockedCompareExchange( &font->shared_key_init, 0, 0 ))
+        {
+            /* other threads using the same font compute the same key */
+            InterlockedCompareExchange64( (LONGLONG *)&font->shared_key, get_shared_font_key( dc, font ), 0 );
+            InterlockedExchange( &font->shared_key_init, TRUE );
+        }
+        if (font->shared_key && (glyph = find_shared_glyph( font, index, flags )))
+            return add_cached_glyph( font, index, flags, glyph );
+    }
+
     if (flags & ETO_GLYPH_INDEX) ggo_flags |= GGO_GLYPH_INDEX;
     indices[0] = index;
     for (i = 0; i < ARRAY_SIZE( indices ); i++)
@@ -804,6 +1189,7 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
+    if (shared_glyph_cache && font->shared_key) add_shared_glyph( font, index, flags, glyph, size );
     return add_cached_glyph( font, index, flags, glyph );
 }
 
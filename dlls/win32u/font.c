@@ -4381,6 +4381,10 @@ static UINT init_font_options(void)
         antialias_fakes = (wcschr( valsW, *(const WCHAR *)info->Data ) != NULL);
     }
 
+    /* size in megabytes of the glyph cache shared between processes, disabled by default */
+    if (get_key_value( wine_fonts_key, "GlyphCacheSize", &val ))
+        set_shared_glyph_cache_size( min( val, 256 ) * 1024 * 1024 );
+
     if ((key = reg_open_hkcu_key( "Control Panel\\Desktop" )))
     {
         /* FIXME: handle vertical orientations even though Windows doesn't */
@@ -1315,38 +1315,6 @@ static void unix_face_destroy( struct unix_face *This )
     free( This );
 }
 
-static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_ptr, SIZE_T data_size,
-                          DWORD face_index, DWORD flags, DWORD *num_faces )
-{
-    struct unix_face *unix_face;
-    int ret;
-
-    if (num_faces) *num_faces = 0;
-
-    if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
-        return 0;
-
-    if (unix_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
-    {
-        TRACE("Ignoring %s since its family name begins with a dot\n", debugstr_a(unix_name));
-        unix_face_destroy( unix_face );
-        return 0;
-    }
-
-    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
-
-    ret = add_gdi_face( unix_face->family_name, unix_face->second_name, unix_face->style_name, unix_face->full_name,
-                        file, data_ptr, data_size, face_index, unix_face->fs, unix_face->ntm_flags,
-                        unix_face->font_version, flags, unix_face->scalable ? NULL : &unix_face->size );
-
-    TRACE("fsCsb = %08x %08x/%08x %08x %08x %08x\n", unix_face->fs.fsCsb[0], unix_face->fs.fsCsb[1],
-          unix_face->fs.fsUsb[0], unix_face->fs.fsUsb[1], unix_face->fs.fsUsb[2], unix_face->fs.fsUsb[3]);
-
-    if (num_faces) *num_faces = unix_face->num_faces;
-    unix_face_destroy( unix_face );
-    return ret;
-}
-
 static WCHAR *get_dos_file_name( LPCSTR str )
 {
     WCHAR *buffer;
@@ -1388,6 +1356,424 @@ static char *get_unix_file_name( LPCWSTR path )
     return buffer;
 }
 
+/* font index
+ *
+ * The properties of every face found while scanning the font directories are stored in
+ * a binary index file, sorted by unix file name and face index. Other processes map that
+ * file and add the faces from it directly instead of opening every font file again,
+ * as long as the file size and modification time still match. The index is rewritten
+ * whenever a process finds a different set of fonts.
+ */
+
+#define FONT_INDEX_MAGIC    0x58444e49  /* "INDX" */
+#define FONT_INDEX_VERSION  2
+
+enum font_index_name
+{
+    FONT_INDEX_UNIX_NAME,
+    FONT_INDEX_FAMILY_NAME,
+    FONT_INDEX_SECOND_NAME,
+    FONT_INDEX_STYLE_NAME,
+    FONT_INDEX_FULL_NAME,
+    FONT_INDEX_NAME_COUNT
+};
+
+struct font_index_entry
+{
+    ULONGLONG               file_size;
+    ULONGLONG               file_mtime;
+    UINT                    entry_size;
+    UINT                    face_index;
+    UINT                    num_faces;
+    UINT                    scalable;
+    UINT                    ntm_flags;
+    UINT                    font_version;
+    FONTSIGNATURE           fs;
+    struct bitmap_font_size size;
+    UINT                    names[FONT_INDEX_NAME_COUNT];  /* offsets from the entry start, 0 if NULL */
+    UINT                    sfnt;
+    /* char                 unix_name[]; */
+    /* WCHAR                family_name[], second_name[], style_name[], full_name[]; */
+};
+
+C_ASSERT( sizeof(struct font_index_entry) % 8 == 0 );
+
+struct font_index_header
+{
+    UINT magic;
+    UINT version;
+    UINT lcid;
+    UINT count;
+    UINT size;
+    UINT offsets[1];  /* offsets of the sorted entries from the header start */
+};
+
+static char *font_index_file;
+static const struct font_index_header *font_index;
+static SIZE_T font_index_size;
+static BOOL font_index_loading;
+static struct font_index_entry **font_index_entries;
+static UINT font_index_count, font_index_max;
+static BOOL font_index_dirty;
+
+static inline const char *font_index_unix_name( const struct font_index_entry *entry )
+{
+    return (const char *)entry + entry->names[FONT_INDEX_UNIX_NAME];
+}
+
+static inline const WCHAR *font_index_name( const struct font_index_entry *entry, enum font_index_name name )
+{
+    if (!entry->names[name]) return NULL;
+    return (const WCHAR *)((const char *)entry + entry->names[name]);
+}
+
+static int font_index_compare( const char *unix_name, UINT face_index, const struct font_index_entry *entry )
+{
+    int ret = strcmp( unix_name, font_index_unix_name( entry ));
+    if (ret) return ret;
+    if (face_index < entry->face_index) return -1;
+    return face_index > entry->face_index;
+}
+
+static int font_index_sort_compare( const void *a, const void *b )
+{
+    const struct font_index_entry *entry = *(const struct font_index_entry * const *)a;
+    return font_index_compare( font_index_unix_name( entry ), entry->face_index,
+                               *(const struct font_index_entry * const *)b );
+}
+
+static BOOL font_index_validate_entry( const struct font_index_entry *entry, UINT max_size )
+{
+    const char *end;
+    int i;
+
+    if (max_size < sizeof(*entry) || entry->entry_size < sizeof(*entry) || entry->entry_size > max_size)
+        return FALSE;
+    if (entry->entry_size % 8) return FALSE;
+    end = (const char *)entry + entry->entry_size;
+
+    if (entry->names[FONT_INDEX_UNIX_NAME] < sizeof(*entry) ||
+        entry->names[FONT_INDEX_UNIX_NAME] >= entry->entry_size) return FALSE;
+    if (!memchr( font_index_unix_name( entry ), 0, end - font_index_unix_name( entry ))) return FALSE;
+
+    for (i = FONT_INDEX_FAMILY_NAME; i < FONT_INDEX_NAME_COUNT; i++)
+    {
+        const WCHAR *name = font_index_name( entry, i );
+
+        if (!name) continue;
+        if (entry->names[i] < sizeof(*entry) || entry->names[i] >= entry->entry_size ||
+            entry->names[i] % sizeof(WCHAR)) return FALSE;
+        while ((const char *)name < end && *name) name++;
+        if ((const char *)name >= end) return FALSE;
+    }
+    return !!entry->names[FONT_INDEX_FAMILY_NAME];
+}
+
+static const struct font_index_header *font_index_map( const char *unix_name, SIZE_T *ret_size )
+{
+    const struct font_index_header *header;
+    struct stat st;
+    void *data;
+    UINT i;
+    int fd;
+
+    if ((fd = open( unix_name, O_RDONLY )) == -1) return NULL;
+    if (fstat( fd, &st ) == -1 || st.st_size < sizeof(*header) || st.st_size > 0x7fffffff)
+    {
+        close( fd );
+        return NULL;
+    }
+    data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (data == MAP_FAILED) return NULL;
+
+    header = data;
+    if (header->magic != FONT_INDEX_MAGIC || header->version != FONT_INDEX_VERSION ||
+        header->lcid != system_lcid || header->size != st.st_size ||
+        header->count > (header->size - offsetof(struct font_index_header, offsets)) / sizeof(UINT))
+        goto invalid;
+
+    for (i = 0; i < header->count; i++)
+    {
+        UINT offset = header->offsets[i];
+
+        if (offset % 8 || offset > header->size) goto invalid;
+        if (!font_index_validate_entry( (const struct font_index_entry *)((const char *)header + offset),
+                                        header->size - offset ))
+            goto invalid;
+    }
+
+    TRACE( "mapped %u entries from %s\n", header->count, debugstr_a(unix_name) );
+    *ret_size = st.st_size;
+    return header;
+
+invalid:
+    WARN( "ignoring invalid font index %s\n", debugstr_a(unix_name) );
+    munmap( data, st.st_size );
+    return NULL;
+}
+
+static const struct font_index_entry *font_index_find( const char *unix_name, UINT face_index,
+                                                       const struct stat *st )
+{
+    const struct font_index_entry *entry;
+    int min = 0, max, res;
+
+    if (!font_index) return NULL;
+
+    max = font_index->count - 1;
+    while (min <= max)
+    {
+        int pos = (min + max) / 2;
+        entry = (const struct font_index_entry *)((const char *)font_index + font_index->offsets[pos]);
+        if (!(res = font_index_compare( unix_name, face_index, entry )))
+        {
+            if (entry->file_size != st->st_size || entry->file_mtime != st->st_mtime) return NULL;
+            return entry;
+        }
+        if (res < 0) max = pos - 1;
+        else min = pos + 1;
+    }
+    return NULL;
+}
+
+static void font_index_append( struct font_index_entry *entry )
+{
+    if (font_index_count == font_index_max)
+    {
+        struct font_index_entry **new_entries;
+        UINT new_max = max( 256, font_index_max * 2 );
+
+        if (!(new_entries = realloc( font_index_entries, new_max * sizeof(*new_entries) )))
+        {
+            free( entry );
+            return;
+        }
+        font_index_entries = new_entries;
+        font_index_max = new_max;
+    }
+    font_index_entries[font_index_count++] = entry;
+}
+
+static void font_index_add_entry( const struct font_index_entry *entry )
+{
+    struct font_index_entry *copy;
+
+    if (!(copy = malloc( entry->entry_size ))) return;
+    memcpy( copy, entry, entry->entry_size );
+    font_index_append( copy );
+}
+
+static void font_index_add_face( const char *unix_name, UINT face_index, const struct stat *st,
+                                 const struct unix_face *face )
+{
+    const WCHAR *names[FONT_INDEX_NAME_COUNT];
+    struct font_index_entry *entry;
+    UINT i, size, len;
+
+    names[FONT_INDEX_FAMILY_NAME] = face->family_name;
+    names[FONT_INDEX_SECOND_NAME] = face->second_name;
+    names[FONT_INDEX_STYLE_NAME] = face->style_name;
+    names[FONT_INDEX_FULL_NAME] = face->full_name;
+    if (!face->family_name) return;
+
+    size = (sizeof(*entry) + strlen( unix_name ) + 1 + sizeof(WCHAR) - 1) & ~(sizeof(WCHAR) - 1);
+    for (i = FONT_INDEX_FAMILY_NAME; i < FONT_INDEX_NAME_COUNT; i++)
+        if (names[i]) size += (lstrlenW( names[i] ) + 1) * sizeof(WCHAR);
+    size = (size + 7) & ~7;
+
+    if (!(entry = calloc( 1, size ))) return;
+    entry->file_size    = st->st_size;
+    entry->file_mtime   = st->st_mtime;
+    entry->entry_size   = size;
+    entry->face_index   = face_index;
+    entry->num_faces    = face->num_faces;
+    entry->scalable     = face->scalable;
+    entry->ntm_flags    = face->ntm_flags;
+    entry->font_version = face->font_version;
+    entry->fs           = face->fs;
+    entry->size         = face->size;
+    entry->sfnt         = !face->ft_face || FT_IS_SFNT( face->ft_face );
+
+    size = sizeof(*entry);
+    entry->names[FONT_INDEX_UNIX_NAME] = size;
+    len = strlen( unix_name ) + 1;
+    memcpy( (char *)entry + size, unix_name, len );
+    size = (size + len + sizeof(WCHAR) - 1) & ~(sizeof(WCHAR) - 1);
+    for (i = FONT_INDEX_FAMILY_NAME; i < FONT_INDEX_NAME_COUNT; i++)
+    {
+        if (!names[i]) continue;
+        entry->names[i] = size;
+        len = (lstrlenW( names[i] ) + 1) * sizeof(WCHAR);
+        memcpy( (char *)entry + size, names[i], len );
+        size += len;
+    }
+
+    font_index_append( entry );
+    font_index_dirty = TRUE;
+}
+
+static void font_index_save(void)
+{
+    struct font_index_header *header;
+    UINT i, count = 0, size, header_size;
+    char *tmp_name, *ptr;
+    int fd;
+
+    header_size = offsetof( struct font_index_header, offsets[font_index_count] );
+    header_size = (header_size + 7) & ~7;
+    size = header_size;
+    for (i = 0; i < font_index_count; i++) size += font_index_entries[i]->entry_size;
+
+    if (!(header = calloc( 1, size ))) return;
+    header->magic   = FONT_INDEX_MAGIC;
+    header->version = FONT_INDEX_VERSION;
+    header->lcid    = system_lcid;
+
+    ptr = (char *)header + header_size;
+    for (i = 0; i < font_index_count; i++)
+    {
+        const struct font_index_entry *entry = font_index_entries[i];
+
+        /* the same file may be found in several directories */
+        if (i && !font_index_sort_compare( &font_index_entries[i - 1], &font_index_entries[i] )) continue;
+        header->offsets[count++] = ptr - (char *)header;
+        memcpy( ptr, entry, entry->entry_size );
+        ptr += entry->entry_size;
+    }
+    header->count = count;
+    header->size = size = ptr - (char *)header;
+
+    if (!(tmp_name = malloc( strlen( font_index_file ) + sizeof(".XXXXXX") ))) goto done;
+    strcpy( tmp_name, font_index_file );
+    strcat( tmp_name, ".XXXXXX" );
+    if ((fd = mkstemp( tmp_name )) != -1)
+    {
+        BOOL ret = write( fd, header, size ) == size;
+
+        close( fd );
+        /* replace atomically, processes still using the old index keep their mapping */
+        if (ret && !rename( tmp_name, font_index_file ))
+            TRACE( "saved %u entries to %s\n", count, debugstr_a(font_index_file) );
+        else
+        {
+            WARN( "failed to write font index %s\n", debugstr_a(font_index_file) );
+            unlink( tmp_name );
+        }
+    }
+    free( tmp_name );
+done:
+    free( header );
+}
+
+static void font_index_init(void)
+{
+    static const WCHAR fntcacheW[] = {'\\','?','?','\\','C',':','\\','w','i','n','d','o','w','s','\\',
+                                      's','y','s','t','e','m','3','2','\\','f','n','t','c','a','c','h','e','.','d','a','t',0};
+
+    if (!(font_index_file = get_unix_file_name( fntcacheW ))) return;
+    font_index = font_index_map( font_index_file, &font_index_size );
+    font_index_loading = TRUE;
+}
+
+static void font_index_done(void)
+{
+    UINT i, count = 0;
+
+    if (!font_index_loading) return;
+    font_index_loading = FALSE;
+
+    /* the same file may be found in several directories, only count it once */
+    qsort( font_index_entries, font_index_count, sizeof(*font_index_entries), font_index_sort_compare );
+    for (i = 0; i < font_index_count; i++)
+        if (!i || font_index_sort_compare( &font_index_entries[i - 1], &font_index_entries[i] )) count++;
+
+    if (font_index_dirty || !font_index || font_index->count != count)
+        font_index_save();
+
+    for (i = 0; i < font_index_count; i++) free( font_index_entries[i] );
+    free( font_index_entries );
+    font_index_entries = NULL;
+    font_index_count = font_index_max = 0;
+
+    if (font_index) munmap( (void *)font_index, font_index_size );
+    font_index = NULL;
+    free( font_index_file );
+    font_index_file = NULL;
+}
+
+static int add_font_index_entry( const struct font_index_entry *entry, const WCHAR *file,
+                                 DWORD flags, DWORD *num_faces )
+{
+    const WCHAR *family_name = font_index_name( entry, FONT_INDEX_FAMILY_NAME );
+
+    font_index_add_entry( entry );
+
+    /* same check as in new_ft_face() */
+    if (!entry->sfnt && (entry->scalable || !(flags & ADDFONT_ALLOW_BITMAP)))
+    {
+        WARN( "Ignoring font %s\n", debugstr_a(font_index_unix_name( entry )) );
+        return 0;
+    }
+
+    if (num_faces) *num_faces = entry->num_faces;
+
+    if (family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
+    {
+        TRACE( "Ignoring %s since its family name begins with a dot\n", debugstr_a(font_index_unix_name( entry )) );
+        return 0;
+    }
+
+    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
+
+    return add_gdi_face( family_name, font_index_name( entry, FONT_INDEX_SECOND_NAME ),
+                         font_index_name( entry, FONT_INDEX_STYLE_NAME ),
+                         font_index_name( entry, FONT_INDEX_FULL_NAME ), file, NULL, 0,
+                         entry->face_index, entry->fs, entry->ntm_flags, entry->font_version,
+                         flags, entry->scalable ? NULL : &entry->size );
+}
+
+static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_ptr, SIZE_T data_size,
+                          DWORD face_index, DWORD flags, DWORD *num_faces )
+{
+    const struct font_index_entry *entry;
+    struct unix_face *unix_face;
+    BOOL use_index;
+    struct stat st;
+    int ret;
+
+    if (num_faces) *num_faces = 0;
+
+    use_index = font_index_loading && unix_name && !data_ptr && !stat( unix_name, &st );
+    if (use_index && (entry = font_index_find( unix_name, face_index, &st )))
+        return add_font_index_entry( entry, file, flags, num_faces );
+
+    if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
+        return 0;
+
+    if (use_index) font_index_add_face( unix_name, face_index, &st, unix_face );
+
+    if (unix_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
+    {
+        TRACE("Ignoring %s since its family name begins with a dot\n", debugstr_a(unix_name));
+        unix_face_destroy( unix_face );
+        return 0;
+    }
+
+    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
+
+    ret = add_gdi_face( unix_face->family_name, unix_face->second_name, unix_face->style_name, unix_face->full_name,
+                        file, data_ptr, data_size, face_index, unix_face->fs, unix_face->ntm_flags,
+                        unix_face->font_version, flags, unix_face->scalable ? NULL : &unix_face->size );
+
+    TRACE("fsCsb = %08x %08x/%08x %08x %08x %08x\n", unix_face->fs.fsCsb[0], unix_face->fs.fsCsb[1],
+          unix_face->fs.fsUsb[0], unix_face->fs.fsUsb[1], unix_face->fs.fsUsb[2], unix_face->fs.fsUsb[3]);
+
+    if (num_faces) *num_faces = unix_face->num_faces;
+    unix_face_destroy( unix_face );
+    return ret;
+}
+
 static INT AddFontToList(const WCHAR *dos_name, const char *unix_name, void *font_data_ptr,
                          DWORD font_data_size, DWORD flags)
 {
@@ -1939,6 +2325,7 @@ static void freetype_load_fonts(void)
 #elif defined(__ANDROID__)
     ReadFontDir("/system/fonts", TRUE);
 #endif
+    font_index_done();
 }
 
 /* Some fonts have large usWinDescent values, as a result of storing signed short
@@ -4295,6 +4682,7 @@ const struct font_backend_funcs *init_freetype_lib(void)
     init_fontconfig();
 #endif
     NtQueryDefaultLocale( FALSE, &system_lcid );
+    font_index_init();
     return &font_funcs;
 }
 
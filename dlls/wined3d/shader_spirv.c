@@ -22,6 +22,7 @@
 
 #include "wined3d_private.h"
 
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 #ifdef SONAME_LIBVKD3D_SHADER
@@ -57,6 +58,16 @@ struct shader_spirv_resource_bindings
     enum wined3d_shader_type so_stage;
 };
 
+struct shader_spirv_compile_stats
+{
+    LARGE_INTEGER frequency;
+    DWORD start_time;
+    unsigned int compile_count;
+    unsigned int ready_count;
+    unsigned int stall_count;
+    LONGLONG stall_time, max_stall_time;
+};
+
 struct shader_spirv_priv
 {
     const struct wined3d_vertex_pipe_ops *vertex_pipe;
@@ -64,6 +75,13 @@ struct shader_spirv_priv
     bool ffp_proj_control;
 
     struct shader_spirv_resource_bindings bindings;
+
+    /* Shader variants are compiled on the thread pool; the CS thread only
+     * waits for a job when it needs the result. */
+    SRWLOCK compile_lock;
+    CONDITION_VARIABLE compile_cv;
+    unsigned int compile_job_count;
+    struct shader_spirv_compile_stats stats;
 };
 
 struct shader_spirv_compile_arguments
@@ -78,6 +96,19 @@ struct shader_spirv_compile_arguments
     } u;
 };
 
+struct shader_spirv_compile_job
+{
+    struct shader_spirv_priv *priv;
+    struct wined3d_device_vk *device_vk;
+    struct wined3d_shader_desc shader_desc;
+    enum wined3d_shader_type shader_type;
+    struct shader_spirv_compile_arguments args;
+    struct shader_spirv_resource_bindings bindings;
+
+    VkShaderModule vk_module;
+    bool done;
+};
+
 struct shader_spirv_graphics_program_variant_vk
 {
     struct shader_spirv_compile_arguments compile_args;
@@ -85,6 +116,7 @@ struct shader_spirv_graphics_program_variant_vk
     size_t binding_base;
 
     VkShaderModule vk_module;
+    struct shader_spirv_compile_job *job;
 };
 
 struct shader_spirv_graphics_program_vk
@@ -98,6 +130,7 @@ struct shader_spirv_graphics_program_vk
 struct shader_spirv_compute_program_vk
 {
     VkShaderModule vk_module;
+    struct shader_spirv_compile_job *job;
     VkPipeline vk_pipeline;
     VkPipelineLayout vk_pipeline_layout;
     VkDescriptorSetLayout vk_set_layout;
@@ -303,7 +336,7 @@ static void shader_spirv_init_shader_interface_vk(struct wined3d_shader_spirv_sh
     iface->vkd3d_interface.uav_counter_count = b->uav_counter_count;
 }
 
-static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *context_vk,
+static VkShaderModule shader_spirv_compile_shader(struct wined3d_device_vk *device_vk,
         const struct wined3d_shader_desc *shader_desc, enum wined3d_shader_type shader_type,
         const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings,
         const struct wined3d_stream_output_desc *so_desc)
@@ -313,7 +346,6 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     VkShaderModuleCreateInfo shader_create_info;
     struct vkd3d_shader_compile_info info;
     const struct wined3d_vk_info *vk_info;
-    struct wined3d_device_vk *device_vk;
     struct vkd3d_shader_code spirv;
     VkShaderModule module;
     char *messages;
@@ -356,7 +388,6 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
         return VK_NULL_HANDLE;
     }
 
-    device_vk = wined3d_device_vk(context_vk->c.device);
     vk_info = &device_vk->vk_info;
 
     shader_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -376,6 +407,185 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     return module;
 }
 
+static void CALLBACK shader_spirv_compile_job_cb(TP_CALLBACK_INSTANCE *instance, void *ctx)
+{
+    struct shader_spirv_compile_job *job = ctx;
+    struct shader_spirv_priv *priv = job->priv;
+
+    TRACE("job %p, shader type %#x.\n", job, job->shader_type);
+
+    job->vk_module = shader_spirv_compile_shader(job->device_vk, &job->shader_desc,
+            job->shader_type, &job->args, &job->bindings, NULL);
+
+    AcquireSRWLockExclusive(&priv->compile_lock);
+    job->done = true;
+    --priv->compile_job_count;
+    WakeAllConditionVariable(&priv->compile_cv);
+    ReleaseSRWLockExclusive(&priv->compile_lock);
+}
+
+static struct shader_spirv_compile_job *shader_spirv_submit_compile_job(struct shader_spirv_priv *priv,
+        struct wined3d_device_vk *device_vk, const struct wined3d_shader *shader,
+        const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings)
+{
+    struct shader_spirv_compile_job *job;
+
+    if (!(job = heap_alloc_zero(sizeof(*job))))
+        return NULL;
+
+    /* The bindings are rebuilt on every select, so the job needs its own
+     * copy. The Vulkan descriptor set layout bindings aren't used for
+     * compilation. */
+    if (!(job->bindings.bindings = heap_calloc(bindings->binding_count, sizeof(*job->bindings.bindings))))
+    {
+        heap_free(job);
+        return NULL;
+    }
+    memcpy(job->bindings.bindings, bindings->bindings, bindings->binding_count * sizeof(*bindings->bindings));
+    job->bindings.bindings_size = job->bindings.binding_count = bindings->binding_count;
+    memcpy(job->bindings.uav_counters, bindings->uav_counters,
+            bindings->uav_counter_count * sizeof(*bindings->uav_counters));
+    job->bindings.uav_counter_count = bindings->uav_counter_count;
+
+    job->priv = priv;
+    job->device_vk = device_vk;
+    job->shader_desc.byte_code = shader->byte_code;
+    job->shader_desc.byte_code_size = shader->byte_code_size;
+    job->shader_type = shader->reg_maps.shader_version.type;
+    if (args)
+        job->args = *args;
+
+    AcquireSRWLockExclusive(&priv->compile_lock);
+    ++priv->compile_job_count;
+    ++priv->stats.compile_count;
+    ReleaseSRWLockExclusive(&priv->compile_lock);
+
+    if (!TrySubmitThreadpoolCallback(shader_spirv_compile_job_cb, job, NULL))
+    {
+        WARN("Failed to submit compile job, compiling synchronously.\n");
+        shader_spirv_compile_job_cb(NULL, job);
+    }
+
+    return job;
+}
+
+/* Waits for the job to complete and frees it, returning the compiled module. */
+static VkShaderModule shader_spirv_complete_compile_job(struct shader_spirv_priv *priv,
+        struct shader_spirv_compile_job *job, bool record_stall)
+{
+    struct shader_spirv_compile_stats *stats = &priv->stats;
+    LARGE_INTEGER start, end;
+    VkShaderModule vk_module;
+    bool stalled = false;
+
+    AcquireSRWLockExclusive(&priv->compile_lock);
+    if (!job->done && record_stall)
+    {
+        stalled = true;
+        QueryPerformanceCounter(&start);
+    }
+    while (!job->done)
+        SleepConditionVariableSRW(&priv->compile_cv, &priv->compile_lock, INFINITE, 0);
+
+    if (stalled)
+    {
+        QueryPerformanceCounter(&end);
+        ++stats->stall_count;
+        stats->stall_time += end.QuadPart - start.QuadPart;
+        stats->max_stall_time = max(stats->max_stall_time, end.QuadPart - start.QuadPart);
+    }
+    else if (record_stall)
+    {
+        ++stats->ready_count;
+    }
+    ReleaseSRWLockExclusive(&priv->compile_lock);
+
+    vk_module = job->vk_module;
+    heap_free(job->bindings.bindings);
+    heap_free(job);
+
+    return vk_module;
+}
+
+static void shader_spirv_report_compile_stats(struct shader_spirv_priv *priv)
+{
+    struct shader_spirv_compile_stats *stats = &priv->stats, report;
+    DWORD time;
+
+    if (!TRACE_ON(d3d_perf))
+        return;
+
+    /* every 1.5 seconds, like the fps channel */
+    time = GetTickCount();
+    AcquireSRWLockExclusive(&priv->compile_lock);
+    if (time - stats->start_time <= 1500)
+    {
+        ReleaseSRWLockExclusive(&priv->compile_lock);
+        return;
+    }
+    report = *stats;
+    stats->start_time = time;
+    stats->compile_count = 0;
+    stats->ready_count = 0;
+    stats->stall_count = 0;
+    stats->stall_time = 0;
+    stats->max_stall_time = 0;
+    ReleaseSRWLockExclusive(&priv->compile_lock);
+
+    if (report.compile_count || report.stall_count)
+        TRACE_(d3d_perf)("%u shader variants compiled, %u were ready when needed, "
+                "%u stalls totalling %.2fms, longest %.2fms.\n",
+                report.compile_count, report.ready_count, report.stall_count,
+                1000.0 * report.stall_time / report.frequency.QuadPart,
+                1000.0 * report.max_stall_time / report.frequency.QuadPart);
+}
+
+static struct shader_spirv_graphics_program_variant_vk *shader_spirv_add_graphics_program_variant_vk(
+        struct shader_spirv_priv *priv, struct wined3d_device_vk *device_vk, struct wined3d_shader *shader,
+        const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings,
+        size_t binding_base, const struct wined3d_stream_output_desc *so_desc)
+{
+    enum wined3d_shader_type shader_type = shader->reg_maps.shader_version.type;
+    struct shader_spirv_graphics_program_variant_vk *variant_vk;
+    struct shader_spirv_graphics_program_vk *program_vk;
+    struct wined3d_shader_desc shader_desc;
+
+    if (!(program_vk = shader->backend_data))
+        return NULL;
+
+    if (!wined3d_array_reserve((void **)&program_vk->variants, &program_vk->variants_size,
+            program_vk->variant_count + 1, sizeof(*program_vk->variants)))
+        return NULL;
+
+    variant_vk = &program_vk->variants[program_vk->variant_count];
+    variant_vk->compile_args = *args;
+    variant_vk->so_desc = so_desc;
+    variant_vk->binding_base = binding_base;
+    variant_vk->vk_module = VK_NULL_HANDLE;
+    variant_vk->job = NULL;
+
+    /* The stream output description belongs to the geometry shader, which
+     * may go away while a job is pending, so compile those variants here. */
+    if (!so_desc && (variant_vk->job = shader_spirv_submit_compile_job(priv, device_vk, shader, args, bindings)))
+    {
+        ++program_vk->variant_count;
+        return variant_vk;
+    }
+
+    shader_desc.byte_code = shader->byte_code;
+    shader_desc.byte_code_size = shader->byte_code_size;
+
+    if (!(variant_vk->vk_module = shader_spirv_compile_shader(device_vk, &shader_desc, shader_type, args,
+            bindings, so_desc)))
+        return NULL;
+    ++program_vk->variant_count;
+
+    return variant_vk;
+}
+
+/* Returns the matching variant, queuing a compile job for it if it doesn't
+ * exist yet. The result isn't necessarily ready; see
+ * shader_spirv_complete_graphics_program_variant_vk(). */
 static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphics_program_variant_vk(
         struct shader_spirv_priv *priv, struct wined3d_context_vk *context_vk, struct wined3d_shader *shader,
         const struct wined3d_state *state, const struct shader_spirv_resource_bindings *bindings)
@@ -386,7 +596,6 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
     const struct wined3d_stream_output_desc *so_desc = NULL;
     struct shader_spirv_graphics_program_vk *program_vk;
     struct shader_spirv_compile_arguments args;
-    struct wined3d_shader_desc shader_desc;
     size_t variant_count, i;
 
     shader_spirv_compile_arguments_init(&args, &context_vk->c, shader, state, context_vk->sample_count);
@@ -405,23 +614,22 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
             return variant_vk;
     }
 
-    if (!wined3d_array_reserve((void **)&program_vk->variants, &program_vk->variants_size,
-            variant_count + 1, sizeof(*program_vk->variants)))
-        return NULL;
-
-    variant_vk = &program_vk->variants[variant_count];
-    variant_vk->compile_args = args;
-    variant_vk->binding_base = binding_base;
-
-    shader_desc.byte_code = shader->byte_code;
-    shader_desc.byte_code_size = shader->byte_code_size;
+    return shader_spirv_add_graphics_program_variant_vk(priv, wined3d_device_vk(context_vk->c.device),
+            shader, &args, bindings, binding_base, so_desc);
+}
 
-    if (!(variant_vk->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc, shader_type, &args,
-            bindings, so_desc)))
-        return NULL;
-    ++program_vk->variant_count;
+static bool shader_spirv_complete_graphics_program_variant_vk(struct shader_spirv_priv *priv,
+        struct shader_spirv_graphics_program_variant_vk *variant_vk)
+{
+    if (variant_vk->job)
+    {
+        variant_vk->vk_module = shader_spirv_complete_compile_job(priv, variant_vk->job, true);
+        variant_vk->job = NULL;
+        if (!variant_vk->vk_module)
+            ERR("Failed to compile shader variant %p.\n", variant_vk);
+    }
 
-    return variant_vk;
+    return !!variant_vk->vk_module;
 }
 
 static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program_vk(struct shader_spirv_priv *priv,
@@ -439,15 +647,24 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     if (!(program = shader->backend_data))
         return NULL;
 
-    if (program->vk_module)
+    if (program->vk_pipeline)
         return program;
 
-    shader_desc.byte_code = shader->byte_code;
-    shader_desc.byte_code_size = shader->byte_code_size;
+    if (program->job)
+    {
+        program->vk_module = shader_spirv_complete_compile_job(priv, program->job, true);
+        program->job = NULL;
+    }
 
-    if (!(program->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc, WINED3D_SHADER_TYPE_COMPUTE,
-            NULL, bindings, NULL)))
-        return NULL;
+    if (!program->vk_module)
+    {
+        shader_desc.byte_code = shader->byte_code;
+        shader_desc.byte_code_size = shader->byte_code_size;
+
+        if (!(program->vk_module = shader_spirv_compile_shader(device_vk, &shader_desc,
+                WINED3D_SHADER_TYPE_COMPUTE, NULL, bindings, NULL)))
+            return NULL;
+    }
 
     if (!(layout = wined3d_context_vk_get_pipeline_layout(context_vk,
             bindings->vk_bindings, bindings->vk_binding_count)))
@@ -666,20 +883,71 @@ static enum wined3d_data_type wined3d_data_type_from_vkd3d(enum vkd3d_shader_res
     }
 }
 
-static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bindings *bindings,
-        struct wined3d_shader_resource_bindings *wined3d_bindings,
-        const struct wined3d_state *state, uint32_t shader_mask)
+static bool shader_spirv_resource_bindings_add_shader(struct shader_spirv_resource_bindings *bindings,
+        struct wined3d_shader_resource_bindings *wined3d_bindings, enum wined3d_shader_type shader_type,
+        const struct vkd3d_shader_scan_descriptor_info *descriptor_info)
 {
-    struct vkd3d_shader_scan_descriptor_info *descriptor_info;
     enum wined3d_shader_descriptor_type wined3d_type;
     enum vkd3d_shader_visibility shader_visibility;
-    enum wined3d_shader_type shader_type;
     VkDescriptorType vk_descriptor_type;
     VkShaderStageFlagBits vk_stage;
-    struct wined3d_shader *shader;
     size_t binding_idx;
     unsigned int i;
 
+    vk_stage = vk_shader_stage_from_wined3d(shader_type);
+    shader_visibility = vkd3d_shader_visibility_from_wined3d(shader_type);
+
+    for (i = 0; i < descriptor_info->descriptor_count; ++i)
+    {
+        struct vkd3d_shader_descriptor_info *d = &descriptor_info->descriptors[i];
+        uint32_t flags;
+
+        if (d->register_space)
+        {
+            WARN("Unsupported register space %u.\n", d->register_space);
+            return false;
+        }
+
+        if (d->resource_type == VKD3D_SHADER_RESOURCE_BUFFER)
+            flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
+        else
+            flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
+
+        vk_descriptor_type = vk_descriptor_type_from_vkd3d(d->type, d->resource_type);
+        if (!shader_spirv_resource_bindings_add_binding(bindings, d->type, vk_descriptor_type,
+                d->register_index, shader_visibility, vk_stage, flags, &binding_idx))
+            return false;
+
+        wined3d_type = wined3d_descriptor_type_from_vkd3d(d->type);
+        if (wined3d_bindings && !wined3d_shader_resource_bindings_add_binding(wined3d_bindings, shader_type,
+                wined3d_type, d->register_index, wined3d_shader_resource_type_from_vkd3d(d->resource_type),
+                wined3d_data_type_from_vkd3d(d->resource_data_type), binding_idx))
+            return false;
+
+        if (d->type == VKD3D_SHADER_DESCRIPTOR_TYPE_UAV
+                && (d->flags & VKD3D_SHADER_DESCRIPTOR_INFO_FLAG_UAV_COUNTER))
+        {
+            if (!shader_spirv_resource_bindings_add_uav_counter_binding(bindings,
+                    d->register_index, shader_visibility, vk_stage, &binding_idx))
+                return false;
+            if (wined3d_bindings && !wined3d_shader_resource_bindings_add_binding(wined3d_bindings,
+                    shader_type, WINED3D_SHADER_DESCRIPTOR_TYPE_UAV_COUNTER, d->register_index,
+                    WINED3D_SHADER_RESOURCE_BUFFER, WINED3D_DATA_UINT, binding_idx))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bindings *bindings,
+        struct wined3d_shader_resource_bindings *wined3d_bindings,
+        const struct wined3d_state *state, uint32_t shader_mask)
+{
+    struct vkd3d_shader_scan_descriptor_info *descriptor_info;
+    enum wined3d_shader_type shader_type;
+    struct wined3d_shader *shader;
+
     bindings->binding_count = 0;
     bindings->uav_counter_count = 0;
     bindings->vk_binding_count = 0;
@@ -704,48 +972,8 @@ static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bin
                 bindings->so_stage = WINED3D_SHADER_TYPE_VERTEX;
         }
 
-        vk_stage = vk_shader_stage_from_wined3d(shader_type);
-        shader_visibility = vkd3d_shader_visibility_from_wined3d(shader_type);
-
-        for (i = 0; i < descriptor_info->descriptor_count; ++i)
-        {
-            struct vkd3d_shader_descriptor_info *d = &descriptor_info->descriptors[i];
-            uint32_t flags;
-
-            if (d->register_space)
-            {
-                WARN("Unsupported register space %u.\n", d->register_space);
-                return false;
-            }
-
-            if (d->resource_type == VKD3D_SHADER_RESOURCE_BUFFER)
-                flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
-            else
-                flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
-
-            vk_descriptor_type = vk_descriptor_type_from_vkd3d(d->type, d->resource_type);
-            if (!shader_spirv_resource_bindings_add_binding(bindings, d->type, vk_descriptor_type,
-                    d->register_index, shader_visibility, vk_stage, flags, &binding_idx))
-                return false;
-
-            wined3d_type = wined3d_descriptor_type_from_vkd3d(d->type);
-            if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings, shader_type,
-                    wined3d_type, d->register_index, wined3d_shader_resource_type_from_vkd3d(d->resource_type),
-                    wined3d_data_type_from_vkd3d(d->resource_data_type), binding_idx))
-                return false;
-
-            if (d->type == VKD3D_SHADER_DESCRIPTOR_TYPE_UAV
-                    && (d->flags & VKD3D_SHADER_DESCRIPTOR_INFO_FLAG_UAV_COUNTER))
-            {
-                if (!shader_spirv_resource_bindings_add_uav_counter_binding(bindings,
-                        d->register_index, shader_visibility, vk_stage, &binding_idx))
-                    return false;
-                if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings,
-                        shader_type, WINED3D_SHADER_DESCRIPTOR_TYPE_UAV_COUNTER, d->register_index,
-                        WINED3D_SHADER_RESOURCE_BUFFER, WINED3D_DATA_UINT, binding_idx))
-                    return false;
-            }
-        }
+        if (!shader_spirv_resource_bindings_add_shader(bindings, wined3d_bindings, shader_type, descriptor_info))
+            return false;
     }
 
     return true;
@@ -789,7 +1017,44 @@ static void shader_spirv_scan_shader(struct wined3d_shader *shader,
     vkd3d_shader_free_messages(messages);
 }
 
-static void shader_spirv_precompile_compute(struct wined3d_shader *shader)
+/* Compute shaders only have a single variant, and pixel shaders always come
+ * first in the descriptor set layout, so the variant most likely to be
+ * used can be compiled as soon as the shader is created. */
+static void shader_spirv_queue_default_variant(struct shader_spirv_priv *priv, struct wined3d_shader *shader,
+        const struct vkd3d_shader_scan_descriptor_info *descriptor_info)
+{
+    enum wined3d_shader_type shader_type = shader->reg_maps.shader_version.type;
+    struct wined3d_device_vk *device_vk = wined3d_device_vk(shader->device);
+    struct shader_spirv_compute_program_vk *compute_program_vk;
+    struct shader_spirv_resource_bindings bindings;
+    struct shader_spirv_compile_arguments args;
+
+    if (!shader->backend_data)
+        return;
+
+    memset(&bindings, 0, sizeof(bindings));
+    if (!shader_spirv_resource_bindings_add_shader(&bindings, NULL, shader_type, descriptor_info))
+    {
+        shader_spirv_resource_bindings_cleanup(&bindings);
+        return;
+    }
+
+    if (shader_type == WINED3D_SHADER_TYPE_COMPUTE)
+    {
+        compute_program_vk = shader->backend_data;
+        compute_program_vk->job = shader_spirv_submit_compile_job(priv, device_vk, shader, NULL, &bindings);
+    }
+    else
+    {
+        memset(&args, 0, sizeof(args));
+        args.u.fs.sample_count = 1;
+        shader_spirv_add_graphics_program_variant_vk(priv, device_vk, shader, &args, &bindings, 0, NULL);
+    }
+
+    shader_spirv_resource_bindings_cleanup(&bindings);
+}
+
+static void shader_spirv_precompile_compute(struct shader_spirv_priv *priv, struct wined3d_shader *shader)
 {
     struct shader_spirv_compute_program_vk *program_vk;
 
@@ -801,6 +1066,7 @@ static void shader_spirv_precompile_compute(struct wined3d_shader *shader)
     }
 
     shader_spirv_scan_shader(shader, &program_vk->descriptor_info);
+    shader_spirv_queue_default_variant(priv, shader, &program_vk->descriptor_info);
 }
 
 static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *shader)
@@ -811,7 +1077,7 @@ static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *sh
 
     if (shader->reg_maps.shader_version.type == WINED3D_SHADER_TYPE_COMPUTE)
     {
-        shader_spirv_precompile_compute(shader);
+        shader_spirv_precompile_compute(shader_priv, shader);
         return;
     }
 
@@ -823,13 +1089,15 @@ static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *sh
     }
 
     shader_spirv_scan_shader(shader, &program_vk->descriptor_info);
+    if (shader->reg_maps.shader_version.type == WINED3D_SHADER_TYPE_PIXEL)
+        shader_spirv_queue_default_variant(shader_priv, shader, &program_vk->descriptor_info);
 }
 
 static void shader_spirv_select(void *shader_priv, struct wined3d_context *context,
         const struct wined3d_state *state)
 {
     struct wined3d_context_vk *context_vk = wined3d_context_vk(context);
-    struct shader_spirv_graphics_program_variant_vk *variant_vk;
+    struct shader_spirv_graphics_program_variant_vk *variants[WINED3D_SHADER_TYPE_GRAPHICS_COUNT] = {NULL};
     struct shader_spirv_resource_bindings *bindings;
     size_t binding_base[WINED3D_SHADER_TYPE_COUNT];
     struct wined3d_pipeline_layout_vk *layout_vk;
@@ -867,11 +1135,25 @@ static void shader_spirv_select(void *shader_priv, struct wined3d_context *conte
             continue;
         }
 
-        if (!(variant_vk = shader_spirv_find_graphics_program_variant_vk(priv, context_vk, shader, state, bindings)))
+        /* Queue all the stages before waiting for any of them, so that
+         * they're compiled in parallel. */
+        if (!(variants[shader_type] = shader_spirv_find_graphics_program_variant_vk(priv,
+                context_vk, shader, state, bindings)))
             goto fail;
-        context_vk->graphics.vk_modules[shader_type] = variant_vk->vk_module;
     }
 
+    for (shader_type = 0; shader_type < ARRAY_SIZE(variants); ++shader_type)
+    {
+        if (!variants[shader_type])
+            continue;
+
+        if (!shader_spirv_complete_graphics_program_variant_vk(priv, variants[shader_type]))
+            goto fail;
+        context_vk->graphics.vk_modules[shader_type] = variants[shader_type]->vk_module;
+    }
+
+    shader_spirv_report_compile_stats(priv);
+
     return;
 
 fail:
@@ -895,6 +1177,7 @@ static void shader_spirv_select_compute(void *shader_priv,
         program = shader_spirv_find_compute_program_vk(priv, context_vk, shader, &priv->bindings);
     else
         program = NULL;
+    shader_spirv_report_compile_stats(priv);
 
     if (program)
     {
@@ -969,6 +1252,9 @@ static void shader_spirv_invalidate_graphics_program_variant(struct wined3d_cont
 {
     enum wined3d_shader_type shader_type;
 
+    if (!variant->vk_module)
+        return;
+
     for (shader_type = 0; shader_type < WINED3D_SHADER_TYPE_GRAPHICS_COUNT; ++shader_type)
     {
         if (context_vk->graphics.vk_modules[shader_type] != variant->vk_module)
@@ -996,6 +1282,8 @@ static void shader_spirv_destroy_compute_vk(struct wined3d_shader *shader)
     struct shader_spirv_compute_program_vk *program = shader->backend_data;
     struct wined3d_vk_info *vk_info = &device_vk->vk_info;
 
+    if (program->job)
+        program->vk_module = shader_spirv_complete_compile_job(device_vk->d.shader_priv, program->job, false);
     shader_spirv_invalidate_contexts_compute_program(&device_vk->d, program);
     VK_CALL(vkDestroyPipeline(device_vk->vk_device, program->vk_pipeline, NULL));
     VK_CALL(vkDestroyShaderModule(device_vk->vk_device, program->vk_module, NULL));
@@ -1025,6 +1313,9 @@ static void shader_spirv_destroy(struct wined3d_shader *shader)
     for (i = 0; i < program_vk->variant_count; ++i)
     {
         variant_vk = &program_vk->variants[i];
+        if (variant_vk->job)
+            variant_vk->vk_module = shader_spirv_complete_compile_job(device_vk->d.shader_priv,
+                    variant_vk->job, false);
         shader_spirv_invalidate_contexts_graphics_program_variant(&device_vk->d, variant_vk);
         VK_CALL(vkDestroyShaderModule(device_vk->vk_device, variant_vk->vk_module, NULL));
     }
@@ -1065,6 +1356,12 @@ static HRESULT shader_spirv_alloc(struct wined3d_device *device,
     fragment_pipe->get_caps(device->adapter, &fragment_caps);
     priv->ffp_proj_control = fragment_caps.wined3d_caps & WINED3D_FRAGMENT_CAP_PROJ_CONTROL;
     memset(&priv->bindings, 0, sizeof(priv->bindings));
+    InitializeSRWLock(&priv->compile_lock);
+    InitializeConditionVariable(&priv->compile_cv);
+    priv->compile_job_count = 0;
+    memset(&priv->stats, 0, sizeof(priv->stats));
+    QueryPerformanceFrequency(&priv->stats.frequency);
+    priv->stats.start_time = GetTickCount();
 
     device->vertex_priv = vertex_priv;
     device->fragment_priv = fragment_priv;
@@ -1077,6 +1374,11 @@ static void shader_spirv_free(struct wined3d_device *device, struct wined3d_cont
 {
     struct shader_spirv_priv *priv = device->shader_priv;
 
+    AcquireSRWLockExclusive(&priv->compile_lock);
+    while (priv->compile_job_count)
+        SleepConditionVariableSRW(&priv->compile_cv, &priv->compile_lock, INFINITE, 0);
+    ReleaseSRWLockExclusive(&priv->compile_lock);
+
     shader_spirv_resource_bindings_cleanup(&priv->bindings);
     priv->fragment_pipe->free_private(device, context);
     priv->vertex_pipe->vp_free(device, context);
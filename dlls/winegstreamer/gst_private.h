@@ -73,7 +73,7 @@ void wg_parser_disconnect(struct wg_parser *parser) DECLSPEC_HIDDEN;
 void wg_parser_begin_flush(struct wg_parser *parser) DECLSPEC_HIDDEN;
 void wg_parser_end_flush(struct wg_parser *parser) DECLSPEC_HIDDEN;
 
-bool wg_parser_get_next_read_offset(struct wg_parser *parser, uint64_t *offset, uint32_t *size) DECLSPEC_HIDDEN;
+bool wg_parser_get_next_read_offset(struct wg_parser *parser, uint64_t *offset, uint32_t *size, void **data) DECLSPEC_HIDDEN;
 void wg_parser_push_data(struct wg_parser *parser, const void *data, uint32_t size) DECLSPEC_HIDDEN;
 
 uint32_t wg_parser_get_stream_count(struct wg_parser *parser) DECLSPEC_HIDDEN;
@@ -104,7 +104,7 @@ void wg_parser_end_flush(struct wg_parser *parser)
     __wine_unix_call(unix_handle, unix_wg_parser_end_flush, parser);
 }
 
-bool wg_parser_get_next_read_offset(struct wg_parser *parser, uint64_t *offset, uint32_t *size)
+bool wg_parser_get_next_read_offset(struct wg_parser *parser, uint64_t *offset, uint32_t *size, void **data)
 {
     struct wg_parser_get_next_read_offset_params params =
     {
@@ -115,6 +115,7 @@ bool wg_parser_get_next_read_offset(struct wg_parser *parser, uint64_t *offset,
         return false;
     *offset = params.offset;
     *size = params.size;
+    *data = params.data;
     return true;
 }
 
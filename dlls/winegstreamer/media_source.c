@@ -613,12 +613,7 @@ static DWORD CALLBACK read_thread(void *arg)
 {
     struct media_source *source = arg;
     IMFByteStream *byte_stream = source->byte_stream;
-    size_t buffer_size = 4096;
     uint64_t file_size;
-    void *data;
-
-    if (!(data = malloc(buffer_size)))
-        return 0;
 
     IMFByteStream_GetLength(byte_stream, &file_size);
 
@@ -629,9 +624,10 @@ static DWORD CALLBACK read_thread(void *arg)
         uint64_t offset;
         ULONG ret_size;
         uint32_t size;
+        void *data;
         HRESULT hr;
 
-        if (!wg_parser_get_next_read_offset(source->wg_parser, &offset, &size))
+        if (!wg_parser_get_next_read_offset(source->wg_parser, &offset, &size, &data))
             continue;
 
         if (offset >= file_size)
@@ -647,12 +643,6 @@ static DWORD CALLBACK read_thread(void *arg)
             continue;
         }
 
-        if (!array_reserve(&data, &buffer_size, size, 1))
-        {
-            free(data);
-            return 0;
-        }
-
         ret_size = 0;
 
         if (SUCCEEDED(hr = IMFByteStream_SetCurrentPosition(byte_stream, offset)))
@@ -664,7 +654,6 @@ static DWORD CALLBACK read_thread(void *arg)
         wg_parser_push_data(source->wg_parser, SUCCEEDED(hr) ? data : NULL, ret_size);
     }
 
-    free(data);
     TRACE("Media source is shutting down; exiting.\n");
     return 0;
 }
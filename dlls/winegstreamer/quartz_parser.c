@@ -786,11 +786,6 @@ static DWORD CALLBACK read_thread(void *arg)
 {
     struct parser *filter = arg;
     LONGLONG file_size, unused;
-    size_t buffer_size = 4096;
-    void *data = NULL;
-
-    if (!(data = malloc(buffer_size)))
-        return 0;
 
     IAsyncReader_Length(filter->reader, &file_size, &unused);
 
@@ -800,9 +795,10 @@ static DWORD CALLBACK read_thread(void *arg)
     {
         uint64_t offset;
         uint32_t size;
+        void *data;
         HRESULT hr;
 
-        if (!wg_parser_get_next_read_offset(filter->wg_parser, &offset, &size))
+        if (!wg_parser_get_next_read_offset(filter->wg_parser, &offset, &size, &data))
             continue;
 
         if (offset >= file_size)
@@ -810,12 +806,6 @@ static DWORD CALLBACK read_thread(void *arg)
         else if (offset + size >= file_size)
             size = file_size - offset;
 
-        if (!array_reserve(&data, &buffer_size, size, 1))
-        {
-            free(data);
-            return 0;
-        }
-
         hr = IAsyncReader_SyncRead(filter->reader, offset, size, data);
         if (FAILED(hr))
             ERR("Failed to read %u bytes at offset %I64u, hr %#x.\n", size, offset, hr);
@@ -823,7 +813,6 @@ static DWORD CALLBACK read_thread(void *arg)
         wg_parser_push_data(filter->wg_parser, SUCCEEDED(hr) ? data : NULL, size);
     }
 
-    free(data);
     TRACE("Streaming stopped; exiting.\n");
     return 0;
 }
@@ -146,6 +146,7 @@ struct wg_parser_get_next_read_offset_params
     struct wg_parser *parser;
     UINT32 size;
     UINT64 offset;
+    void *data;
 };
 
 struct wg_parser_push_data_params
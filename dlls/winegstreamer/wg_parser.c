@@ -56,6 +56,18 @@ GST_DEBUG_CATEGORY_STATIC(wine);
 
 typedef BOOL (*init_gst_cb)(struct wg_parser *parser);
 
+#define READ_CACHE_BLOCKS    4
+#define READ_CACHE_MIN_SIZE  (16 * 1024)
+#define READ_CACHE_MAX_SIZE  (1024 * 1024)
+
+struct read_cache_block
+{
+    void *data;
+    uint64_t offset;
+    uint32_t size, capacity;
+    unsigned int age;
+};
+
 struct wg_parser
 {
     init_gst_cb init_gst;
@@ -87,6 +99,16 @@ struct wg_parser
         bool ret;
     } read_request;
 
+    struct
+    {
+        struct read_cache_block blocks[READ_CACHE_BLOCKS];
+        unsigned int age;
+        /* Size of the next read-ahead, doubled on sequential reads and
+         * reset when the parser seeks elsewhere. */
+        uint32_t read_size;
+        uint64_t reads, hits, requests, request_bytes;
+    } read_cache;
+
     bool flushing, sink_connected;
 
     bool unlimited_buffering;
@@ -567,6 +589,9 @@ static NTSTATUS wg_parser_get_next_read_offset(void *args)
 
     params->offset = parser->read_request.offset;
     params->size = parser->read_request.size;
+    /* The buffer stays mapped until the request is completed by
+     * wg_parser_push_data(), so the client can read into it directly. */
+    params->data = parser->read_request.data;
 
     pthread_mutex_unlock(&parser->mutex);
     return S_OK;
@@ -583,7 +608,7 @@ static NTSTATUS wg_parser_push_data(void *args)
     parser->read_request.size = size;
     parser->read_request.done = true;
     parser->read_request.ret = !!data;
-    if (data)
+    if (data && data != parser->read_request.data)
         memcpy(parser->read_request.data, data, size);
     parser->read_request.data = NULL;
     pthread_mutex_unlock(&parser->mutex);
@@ -696,6 +721,8 @@ static NTSTATUS wg_parser_stream_copy_buffer(void *args)
     assert(stream->event.type == WG_PARSER_EVENT_BUFFER);
     assert(offset < stream->map_info.size);
     assert(offset + size <= stream->map_info.size);
+    /* Output is still copied once from the decoded buffer into the client's
+     * sample; only the input side reads directly into GStreamer memory. */
     memcpy(params->data, stream->map_info.data + offset, size);
 
     pthread_mutex_unlock(&parser->mutex);
@@ -1272,12 +1299,125 @@ static void pad_removed_cb(GstElement *element, GstPad *pad, gpointer user)
     g_free(name);
 }
 
+/* Ask the client for data and wait for it. Called with the parser mutex held. */
+static bool issue_read_request(struct wg_parser *parser, uint64_t offset, uint32_t size,
+        void *data, uint32_t *ret_size)
+{
+    assert(!parser->read_request.data);
+    parser->read_request.data = data;
+    parser->read_request.offset = offset;
+    parser->read_request.size = size;
+    parser->read_request.done = false;
+    pthread_cond_signal(&parser->read_cond);
+
+    /* Note that we don't unblock this wait on GST_EVENT_FLUSH_START. We expect
+     * the upstream pin to flush if necessary. We should never be blocked on
+     * read_thread() not running. */
+
+    while (!parser->read_request.done)
+        pthread_cond_wait(&parser->read_done_cond, &parser->mutex);
+
+    ++parser->read_cache.requests;
+    parser->read_cache.request_bytes += parser->read_request.size;
+
+    *ret_size = parser->read_request.size;
+    return parser->read_request.ret;
+}
+
+/* Called with the parser mutex held. */
+static void free_read_cache(struct wg_parser *parser)
+{
+    unsigned int i;
+
+    if (parser->read_cache.reads)
+        GST_INFO("Parser %p: %" G_GUINT64_FORMAT " reads, %" G_GUINT64_FORMAT " from cache, "
+                "%" G_GUINT64_FORMAT " requests, %" G_GUINT64_FORMAT " bytes per request.", parser,
+                parser->read_cache.reads, parser->read_cache.hits, parser->read_cache.requests,
+                parser->read_cache.requests ? parser->read_cache.request_bytes / parser->read_cache.requests : 0);
+
+    for (i = 0; i < READ_CACHE_BLOCKS; ++i)
+        free(parser->read_cache.blocks[i].data);
+    memset(&parser->read_cache, 0, sizeof(parser->read_cache));
+}
+
+/* Read data through the read-ahead cache. Small reads are served from a
+ * cached block, reading a new block of read_size bytes if needed, so that
+ * demuxers reading a few bytes at a time don't wait on the client for each
+ * of them. Reads of at least read_size bytes go straight to the client. */
+static bool read_data(struct wg_parser *parser, uint64_t offset, uint32_t size,
+        void *data, uint32_t *ret_size)
+{
+    struct read_cache_block *block = NULL, *lru = NULL;
+    bool sequential = false;
+    unsigned int i;
+
+    *ret_size = 0;
+    ++parser->read_cache.reads;
+
+    for (i = 0; i < READ_CACHE_BLOCKS; ++i)
+    {
+        struct read_cache_block *b = &parser->read_cache.blocks[i];
+
+        if (b->size && offset >= b->offset && offset <= b->offset + b->size)
+        {
+            sequential = true;
+            if (offset + size <= b->offset + b->size)
+                block = b;
+        }
+        if (!lru || b->age < lru->age)
+            lru = b;
+    }
+
+    if (!sequential)
+        parser->read_cache.read_size = READ_CACHE_MIN_SIZE;
+    else if (!block && parser->read_cache.read_size < READ_CACHE_MAX_SIZE)
+        parser->read_cache.read_size *= 2;
+
+    if (block)
+    {
+        ++parser->read_cache.hits;
+        block->age = ++parser->read_cache.age;
+        memcpy(data, (uint8_t *)block->data + (offset - block->offset), size);
+        *ret_size = size;
+        return true;
+    }
+
+    if (size >= parser->read_cache.read_size)
+        return issue_read_request(parser, offset, size, data, ret_size);
+
+    if (lru->capacity < parser->read_cache.read_size)
+    {
+        void *new_data;
+
+        if (!(new_data = realloc(lru->data, parser->read_cache.read_size)))
+            return issue_read_request(parser, offset, size, data, ret_size);
+        lru->data = new_data;
+        lru->capacity = parser->read_cache.read_size;
+    }
+
+    /* The mutex is dropped while waiting for the client; make sure the block
+     * is neither used nor recycled in the meantime. */
+    lru->offset = offset;
+    lru->size = 0;
+    lru->age = ++parser->read_cache.age;
+    if (!issue_read_request(parser, offset, parser->read_cache.read_size, lru->data, &lru->size))
+    {
+        lru->size = 0;
+        return false;
+    }
+
+    *ret_size = min(size, lru->size);
+    memcpy(data, lru->data, *ret_size);
+    return true;
+}
+
 static GstFlowReturn src_getrange_cb(GstPad *pad, GstObject *parent,
         guint64 offset, guint size, GstBuffer **buffer)
 {
     struct wg_parser *parser = gst_pad_get_element_private(pad);
     GstBuffer *new_buffer = NULL;
     GstMapInfo map_info;
+    uint32_t ret_size;
     bool ret;
 
     GST_LOG("pad %p, offset %" G_GINT64_MODIFIER "u, size %u, buffer %p.", pad, offset, size, *buffer);
@@ -1302,27 +1442,11 @@ static GstFlowReturn src_getrange_cb(GstPad *pad, GstObject *parent,
     gst_buffer_map(*buffer, &map_info, GST_MAP_WRITE);
 
     pthread_mutex_lock(&parser->mutex);
-
-    assert(!parser->read_request.data);
-    parser->read_request.data = map_info.data;
-    parser->read_request.offset = offset;
-    parser->read_request.size = size;
-    parser->read_request.done = false;
-    pthread_cond_signal(&parser->read_cond);
-
-    /* Note that we don't unblock this wait on GST_EVENT_FLUSH_START. We expect
-     * the upstream pin to flush if necessary. We should never be blocked on
-     * read_thread() not running. */
-
-    while (!parser->read_request.done)
-        pthread_cond_wait(&parser->read_done_cond, &parser->mutex);
-
-    ret = parser->read_request.ret;
-    gst_buffer_set_size(*buffer, parser->read_request.size);
-
+    ret = read_data(parser, offset, size, map_info.data, &ret_size);
     pthread_mutex_unlock(&parser->mutex);
 
     gst_buffer_unmap(*buffer, &map_info);
+    gst_buffer_set_size(*buffer, ret_size);
 
     GST_LOG("Request returned %d.", ret);
 
@@ -1746,6 +1870,7 @@ out:
 
     pthread_mutex_lock(&parser->mutex);
     parser->sink_connected = false;
+    free_read_cache(parser);
     pthread_mutex_unlock(&parser->mutex);
     pthread_cond_signal(&parser->read_cond);
 
@@ -1774,6 +1899,7 @@ static NTSTATUS wg_parser_disconnect(void *args)
 
     pthread_mutex_lock(&parser->mutex);
     parser->sink_connected = false;
+    free_read_cache(parser);
     pthread_mutex_unlock(&parser->mutex);
     pthread_cond_signal(&parser->read_cond);
 
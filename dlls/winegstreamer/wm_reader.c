@@ -170,13 +170,8 @@ static DWORD CALLBACK read_thread(void *arg)
 {
     struct wm_reader *reader = arg;
     IStream *stream = reader->source_stream;
-    size_t buffer_size = 4096;
     uint64_t file_size;
     STATSTG stat;
-    void *data;
-
-    if (!(data = malloc(buffer_size)))
-        return 0;
 
     IStream_Stat(stream, &stat, STATFLAG_NONAME);
     file_size = stat.cbSize.QuadPart;
@@ -189,9 +184,10 @@ static DWORD CALLBACK read_thread(void *arg)
         uint64_t offset;
         ULONG ret_size;
         uint32_t size;
+        void *data;
         HRESULT hr;
 
-        if (!wg_parser_get_next_read_offset(reader->wg_parser, &offset, &size))
+        if (!wg_parser_get_next_read_offset(reader->wg_parser, &offset, &size, &data))
             continue;
 
         if (offset >= file_size)
@@ -205,12 +201,6 @@ static DWORD CALLBACK read_thread(void *arg)
             continue;
         }
 
-        if (!array_reserve(&data, &buffer_size, size, 1))
-        {
-            free(data);
-            return 0;
-        }
-
         ret_size = 0;
 
         stream_offset.QuadPart = offset;
@@ -223,7 +213,6 @@ static DWORD CALLBACK read_thread(void *arg)
         wg_parser_push_data(reader->wg_parser, SUCCEEDED(hr) ? data : NULL, ret_size);
     }
 
-    free(data);
     TRACE("Reader is shutting down; exiting.\n");
     return 0;
 }
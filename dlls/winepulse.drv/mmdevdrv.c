@@ -548,21 +548,17 @@ static HRESULT get_audio_session(const GUID *sessionguid,
     return S_OK;
 }
 
-static HRESULT WINAPI AudioClient_Initialize(IAudioClient3 *iface,
-        AUDCLNT_SHAREMODE mode, DWORD flags, REFERENCE_TIME duration,
-        REFERENCE_TIME period, const WAVEFORMATEX *fmt,
+/* period is the engine period requested through IAudioClient3, or 0 for the default */
+static HRESULT init_stream(ACImpl *This, AUDCLNT_SHAREMODE mode, DWORD flags,
+        REFERENCE_TIME duration, REFERENCE_TIME period, const WAVEFORMATEX *fmt,
         const GUID *sessionguid)
 {
-    ACImpl *This = impl_from_IAudioClient3(iface);
     struct create_stream_params params;
     unsigned int i, channel_count;
     struct pulse_stream *stream;
     char *name;
     HRESULT hr;
 
-    TRACE("(%p)->(%x, %x, %s, %s, %p, %s)\n", This, mode, flags,
-          wine_dbgstr_longlong(duration), wine_dbgstr_longlong(period), fmt, debugstr_guid(sessionguid));
-
     if (!fmt)
         return E_POINTER;
     dump_fmt(fmt);
@@ -613,6 +609,7 @@ static HRESULT WINAPI AudioClient_Initialize(IAudioClient3 *iface,
     params.mode     = mode;
     params.flags    = flags;
     params.duration = duration;
+    params.period   = period;
     params.fmt      = fmt;
     params.stream   = &stream;
     params.channel_count = &channel_count;
@@ -652,6 +649,20 @@ static HRESULT WINAPI AudioClient_Initialize(IAudioClient3 *iface,
     return S_OK;
 }
 
+static HRESULT WINAPI AudioClient_Initialize(IAudioClient3 *iface,
+        AUDCLNT_SHAREMODE mode, DWORD flags, REFERENCE_TIME duration,
+        REFERENCE_TIME period, const WAVEFORMATEX *fmt,
+        const GUID *sessionguid)
+{
+    ACImpl *This = impl_from_IAudioClient3(iface);
+
+    TRACE("(%p)->(%x, %x, %s, %s, %p, %s)\n", This, mode, flags,
+          wine_dbgstr_longlong(duration), wine_dbgstr_longlong(period), fmt, debugstr_guid(sessionguid));
+
+    /* the period is only meaningful in exclusive mode, which isn't supported */
+    return init_stream(This, mode, flags, duration, 0, fmt, sessionguid);
+}
+
 static HRESULT WINAPI AudioClient_GetBufferSize(IAudioClient3 *iface,
         UINT32 *out)
 {
@@ -1084,21 +1095,44 @@ static HRESULT WINAPI AudioClient_GetSharedModeEnginePeriod(IAudioClient3 *iface
         UINT32 *min_period_frames, UINT32 *max_period_frames)
 {
     ACImpl *This = impl_from_IAudioClient3(iface);
+    REFERENCE_TIME def_period, min_period;
 
-    FIXME("(%p)->(%p, %p, %p, %p, %p)\n", This, format, default_period_frames, unit_period_frames,
+    TRACE("(%p)->(%p, %p, %p, %p, %p)\n", This, format, default_period_frames, unit_period_frames,
             min_period_frames, max_period_frames);
 
-    return E_NOTIMPL;
+    if (!format || !default_period_frames || !unit_period_frames ||
+            !min_period_frames || !max_period_frames)
+        return E_POINTER;
+
+    def_period = pulse_config.modes[This->dataflow == eCapture].def_period;
+    min_period = pulse_config.modes[This->dataflow == eCapture].min_period;
+
+    /* PulseAudio takes any period between the minimum and the default */
+    *default_period_frames = MulDiv(def_period, format->nSamplesPerSec, 10000000);
+    *min_period_frames = MulDiv(min_period, format->nSamplesPerSec, 10000000);
+    *max_period_frames = *default_period_frames;
+    *unit_period_frames = 1;
+
+    return S_OK;
 }
 
 static HRESULT WINAPI AudioClient_GetCurrentSharedModeEnginePeriod(IAudioClient3 *iface,
         WAVEFORMATEX **cur_format, UINT32 *cur_period_frames)
 {
     ACImpl *This = impl_from_IAudioClient3(iface);
+    REFERENCE_TIME period = pulse_config.modes[This->dataflow == eCapture].def_period;
+    HRESULT hr;
 
-    FIXME("(%p)->(%p, %p)\n", This, cur_format, cur_period_frames);
+    TRACE("(%p)->(%p, %p)\n", This, cur_format, cur_period_frames);
 
-    return E_NOTIMPL;
+    if (!cur_format || !cur_period_frames)
+        return E_POINTER;
+
+    if (FAILED(hr = AudioClient_GetMixFormat(iface, cur_format)))
+        return hr;
+
+    *cur_period_frames = MulDiv(period, (*cur_format)->nSamplesPerSec, 10000000);
+    return S_OK;
 }
 
 static HRESULT WINAPI AudioClient_InitializeSharedAudioStream(IAudioClient3 *iface,
@@ -1106,10 +1140,26 @@ static HRESULT WINAPI AudioClient_InitializeSharedAudioStream(IAudioClient3 *ifa
         const GUID *session_guid)
 {
     ACImpl *This = impl_from_IAudioClient3(iface);
+    UINT32 default_period, unit_period, min_period, max_period;
+    REFERENCE_TIME period;
+    HRESULT hr;
 
-    FIXME("(%p)->(0x%x, %u, %p, %s)\n", This, flags, period_frames, format, debugstr_guid(session_guid));
+    TRACE("(%p)->(0x%x, %u, %p, %s)\n", This, flags, period_frames, format, debugstr_guid(session_guid));
 
-    return E_NOTIMPL;
+    if (!format)
+        return E_POINTER;
+    if (!format->nSamplesPerSec)
+        return E_INVALIDARG;
+
+    hr = AudioClient_GetSharedModeEnginePeriod(iface, format, &default_period, &unit_period,
+            &min_period, &max_period);
+    if (FAILED(hr))
+        return hr;
+    if (period_frames < min_period || period_frames > max_period)
+        return E_INVALIDARG;
+
+    period = ((REFERENCE_TIME)period_frames * 10000000 + format->nSamplesPerSec - 1) / format->nSamplesPerSec;
+    return init_stream(This, AUDCLNT_SHAREMODE_SHARED, flags, 0, period, format, session_guid);
 }
 
 static const IAudioClient3Vtbl AudioClient3_Vtbl =
@@ -856,7 +856,10 @@ static NTSTATUS pulse_create_stream(void *args)
     if (FAILED(hr))
         goto exit;
 
+    /* a period is only requested through IAudioClient3::InitializeSharedAudioStream() */
     period = pulse_def_period[stream->dataflow == eCapture];
+    if (params->period)
+        period = max(params->period, pulse_min_period[stream->dataflow == eCapture]);
     if (duration < 3 * period)
         duration = 3 * period;
 
@@ -1800,7 +1803,7 @@ static NTSTATUS pulse_get_latency(void *args)
         lat = attr->minreq / pa_frame_size(&stream->ss);
     else
         lat = attr->fragsize / pa_frame_size(&stream->ss);
-    *params->latency = (lat * 10000000) / stream->ss.rate + pulse_def_period[0];
+    *params->latency = (lat * 10000000) / stream->ss.rate + stream->mmdev_period_usec * 10;
     pulse_unlock();
     TRACE("Latency: %u ms\n", (DWORD)(*params->latency / 10000));
     params->result = S_OK;
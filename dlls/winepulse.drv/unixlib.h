@@ -44,6 +44,7 @@ struct create_stream_params
     AUDCLNT_SHAREMODE mode;
     DWORD flags;
     REFERENCE_TIME duration;
+    REFERENCE_TIME period;
     const WAVEFORMATEX *fmt;
     HRESULT result;
     UINT32 *channel_count;
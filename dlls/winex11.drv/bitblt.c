@@ -1573,6 +1573,9 @@ struct x11drv_window_surface
 #ifdef HAVE_LIBXXSHM
     XShmSegmentInfo       shminfo;
 #endif
+    DWORD                 stats_time;     /* start of the current statistics period */
+    ULONGLONG             stats_bytes;    /* bytes presented during the period */
+    UINT                  stats_flushes;  /* number of flushes during the period */
     CRITICAL_SECTION      crit;
     BITMAPINFO            info;   /* variable size, must be last */
 };
@@ -1886,6 +1889,60 @@ static void CDECL x11drv_surface_set_region( struct window_surface *window_surfa
     window_surface->funcs->unlock( window_surface );
 }
 
+/***********************************************************************
+ *           put_surface_image
+ *
+ * Send a rectangle of the surface image to the window.
+ */
+static UINT put_surface_image( struct x11drv_window_surface *surface, int x, int y, int width, int height )
+{
+    if (width <= 0 || height <= 0) return 0;
+#ifdef HAVE_LIBXXSHM
+    if (surface->shminfo.shmid != -1)
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image, x, y,
+                      surface->header.rect.left + x, surface->header.rect.top + y,
+                      width, height, False );
+    else
+#endif
+    XPutImage( gdi_display, surface->window, surface->gc, surface->image, x, y,
+               surface->header.rect.left + x, surface->header.rect.top + y, width, height );
+    return height * ((width * surface->image->bits_per_pixel + 7) / 8);
+}
+
+/***********************************************************************
+ *           present_surface
+ *
+ * Present the damaged part of the surface. The window region, if any, is
+ * already applied as the GC clip rectangles by x11drv_surface_set_region.
+ */
+static void present_surface( struct x11drv_window_surface *surface, const RECT *visrect )
+{
+    UINT bytes;
+    DWORD now;
+
+    bytes = put_surface_image( surface, visrect->left, visrect->top,
+                               visrect->right - visrect->left, visrect->bottom - visrect->top );
+
+    if (!TRACE_ON(bitblt)) return;
+
+    now = GetTickCount();
+    surface->stats_bytes += bytes;
+    surface->stats_flushes++;
+    if (now - surface->stats_time >= 1000)
+    {
+        const char *mode = "copy";
+#ifdef HAVE_LIBXXSHM
+        if (surface->shminfo.shmid != -1) mode = surface->bits == surface->image->data ? "shm" : "shm copy";
+#endif
+        TRACE( "surface %p: %s presented %s bytes/sec in %u flushes\n", surface, mode,
+               wine_dbgstr_longlong( surface->stats_bytes * 1000 / (now - surface->stats_time) ),
+               surface->stats_flushes );
+        surface->stats_time = now;
+        surface->stats_bytes = 0;
+        surface->stats_flushes = 0;
+    }
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
@@ -1931,22 +1988,7 @@ static void CDECL x11drv_surface_flush( struct window_surface *window_surface )
                     ptr[x] |= surface->alpha_bits;
         }
 
-#ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
-        else
-#endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
+        present_surface( surface, &coords.visrect );
         XFlush( gdi_display );
     }
     reset_bounds( &surface->bounds );
@@ -2026,6 +2068,7 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     surface->is_argb = (use_alpha && vis->depth == 32 && surface->info.bmiHeader.biCompression == BI_RGB);
     set_color_key( surface, color_key );
     reset_bounds( &surface->bounds );
+    surface->stats_time = GetTickCount();
 
 #ifdef HAVE_LIBXXSHM
     surface->image = create_shm_image( vis, width, height, &surface->shminfo );
@@ -122,7 +122,52 @@ static const WCHAR *attribute_table[] =
     NULL                            /* WINHTTP_QUERY_PASSPORT_CONFIG            = 78 */
 };
 
-static DWORD start_queue( struct queue *queue )
+typedef void (*task_callback_func)( void *ctx );
+
+struct task
+{
+    struct list entry;
+    task_callback_func callback;
+    void *ctx;
+};
+
+/* Request tasks do blocking network I/O, so they get their own pool rather than the process
+ * one. Each of them returns within the timeouts of its request handle, so capping the pool only
+ * delays tasks beyond the limit instead of creating a thread for every concurrent request. */
+#define TASK_POOL_MAX_THREADS 64
+
+static TP_POOL *task_pool;
+static TP_CALLBACK_ENVIRON task_env;
+
+static BOOL WINAPI init_task_pool( INIT_ONCE *once, void *param, void **ctx )
+{
+    if (!(task_pool = CreateThreadpool( NULL ))) return FALSE;
+    SetThreadpoolThreadMaximum( task_pool, TASK_POOL_MAX_THREADS );
+
+    memset( &task_env, 0, sizeof(task_env) );
+    task_env.Version = 1;
+    task_env.Pool = task_pool;
+    return TRUE;
+}
+
+void release_task_pool( void )
+{
+    if (task_pool) CloseThreadpool( task_pool );
+    task_pool = NULL;
+}
+
+void init_queue( struct queue *queue, struct object_header *owner, BOOL private_pool )
+{
+    InitializeSRWLock( &queue->lock );
+    list_init( &queue->tasks );
+    queue->callback_running = FALSE;
+    queue->private_pool = private_pool;
+    queue->pool = NULL;
+    queue->owner = owner;
+}
+
+/* called with the queue lock held */
+static DWORD start_private_pool( struct queue *queue )
 {
     if (queue->pool) return ERROR_SUCCESS;
 
@@ -140,25 +185,84 @@ static DWORD start_queue( struct queue *queue )
 
 void stop_queue( struct queue *queue )
 {
-    if (!queue->pool) return;
-    CloseThreadpool( queue->pool );
-    queue->pool = NULL;
-    TRACE("stopped %p\n", queue);
+    AcquireSRWLockExclusive( &queue->lock );
+    if (queue->pool)
+    {
+        CloseThreadpool( queue->pool );
+        queue->pool = NULL;
+        TRACE("stopped %p\n", queue);
+    }
+    ReleaseSRWLockExclusive( &queue->lock );
 }
 
-static DWORD queue_task( struct queue *queue, PTP_WORK_CALLBACK task, void *ctx )
+static void CALLBACK task_callback( TP_CALLBACK_INSTANCE *instance, void *ctx )
 {
-    TP_WORK *work;
-    DWORD ret;
+    struct queue *queue = ctx;
+    struct object_header *owner = queue->owner;
+    struct task *task;
+    struct list *entry;
 
-    if ((ret = start_queue( queue ))) return ret;
+    for (;;)
+    {
+        AcquireSRWLockExclusive( &queue->lock );
+        if (!(entry = list_head( &queue->tasks )))
+        {
+            queue->callback_running = FALSE;
+            ReleaseSRWLockExclusive( &queue->lock );
+            break;
+        }
+        list_remove( entry );
+        ReleaseSRWLockExclusive( &queue->lock );
 
-    if (!(work = CreateThreadpoolWork( task, ctx, &queue->env ))) return GetLastError();
-    TRACE("queueing %p in %p\n", work, queue);
-    SubmitThreadpoolWork( work );
-    CloseThreadpoolWork( work );
+        task = LIST_ENTRY( entry, struct task, entry );
+        task->callback( task->ctx );
+        free( task );
+    }
 
-    return ERROR_SUCCESS;
+    /* may free the queue */
+    release_object( owner );
+}
+
+/* Queued tasks are run by a single thread pool callback per queue, which keeps them ordered
+ * without tying up a thread while the queue is idle. The callback holds a reference to the
+ * owner of the queue, and each task one to the object it works on, so no task can outlive
+ * the handle it was queued for. Queues whose tasks may block indefinitely, such as websocket
+ * receives, run on a private single thread pool instead of the shared one so that they cannot
+ * starve other handles. */
+static DWORD queue_task( struct queue *queue, task_callback_func callback, void *ctx )
+{
+    static INIT_ONCE once = INIT_ONCE_STATIC_INIT;
+    struct task *task;
+    DWORD ret = ERROR_SUCCESS;
+
+    if (!queue->private_pool && !InitOnceExecuteOnce( &once, init_task_pool, NULL, NULL ))
+        return GetLastError();
+    if (!(task = malloc( sizeof(*task) ))) return ERROR_OUTOFMEMORY;
+    task->callback = callback;
+    task->ctx = ctx;
+
+    TRACE("queueing %p in %p\n", ctx, queue);
+
+    AcquireSRWLockExclusive( &queue->lock );
+    list_add_tail( &queue->tasks, &task->entry );
+    if (!queue->callback_running)
+    {
+        addref_object( queue->owner );
+        if (queue->private_pool) ret = start_private_pool( queue );
+        if (!ret && TrySubmitThreadpoolCallback( task_callback, queue,
+                                                 queue->private_pool ? &queue->env : &task_env ))
+            queue->callback_running = TRUE;
+        else
+        {
+            if (!ret) ret = GetLastError();
+            list_remove( &task->entry );
+            release_object( queue->owner );
+            free( task );
+        }
+    }
+    ReleaseSRWLockExclusive( &queue->lock );
+
+    return ret;
 }
 
 static void free_header( struct header *header )
@@ -2166,11 +2270,11 @@ end:
     return ret;
 }
 
-static void CALLBACK task_send_request( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_send_request( void *ctx )
 {
     struct send_request *s = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     send_request( s->request, s->headers, s->headers_len, s->optional, s->optional_len, s->total_len, s->context, TRUE );
 
     release_object( &s->request->hdr );
@@ -2752,11 +2856,11 @@ static DWORD receive_response( struct request *request, BOOL async )
     return ret;
 }
 
-static void CALLBACK task_receive_response( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_receive_response( void *ctx )
 {
     struct receive_response *r = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     receive_response( r->request, TRUE );
 
     release_object( &r->request->hdr );
@@ -2851,11 +2955,11 @@ done:
     return ret;
 }
 
-static void CALLBACK task_query_data_available( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_query_data_available( void *ctx )
 {
     struct query_data *q = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     query_data_available( q->request, q->available, TRUE );
 
     release_object( &q->request->hdr );
@@ -2908,11 +3012,11 @@ BOOL WINAPI WinHttpQueryDataAvailable( HINTERNET hrequest, LPDWORD available )
     return !ret || ret == ERROR_IO_PENDING;
 }
 
-static void CALLBACK task_read_data( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_read_data( void *ctx )
 {
     struct read_data *r = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     read_data( r->request, r->buffer, r->to_read, r->read, TRUE );
 
     release_object( &r->request->hdr );
@@ -2989,11 +3093,11 @@ static DWORD write_data( struct request *request, const void *buffer, DWORD to_w
     return ret;
 }
 
-static void CALLBACK task_write_data( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_write_data( void *ctx )
 {
     struct write_data *w = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     write_data( w->request, w->buffer, w->to_write, w->written, TRUE );
 
     release_object( &w->request->hdr );
@@ -3113,6 +3217,8 @@ HINTERNET WINAPI WinHttpWebSocketCompleteUpgrade( HINTERNET hrequest, DWORD_PTR
 
     addref_object( &request->hdr );
     socket->request = request;
+    init_queue( &socket->send_q, &socket->hdr, TRUE );
+    init_queue( &socket->recv_q, &socket->hdr, TRUE );
 
     if ((hsocket = alloc_handle( &socket->hdr )))
     {
@@ -3238,11 +3344,11 @@ static DWORD socket_send( struct socket *socket, WINHTTP_WEB_SOCKET_BUFFER_TYPE
     return ret;
 }
 
-static void CALLBACK task_socket_send( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_socket_send( void *ctx )
 {
     struct socket_send *s = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     socket_send( s->socket, s->type, s->buf, s->len, TRUE );
 
     release_object( &s->socket->hdr );
@@ -3365,11 +3471,11 @@ static DWORD receive_frame( struct socket *socket, DWORD *ret_len, enum socket_o
     return ERROR_SUCCESS;
 }
 
-static void CALLBACK task_socket_send_pong( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_socket_send_pong( void *ctx )
 {
     struct socket_send *s = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     send_frame( s->socket, SOCKET_OPCODE_PONG, 0, NULL, 0, TRUE );
 
     release_object( &s->socket->hdr );
@@ -3497,11 +3603,11 @@ static DWORD socket_receive( struct socket *socket, void *buf, DWORD len, DWORD
     return ret;
 }
 
-static void CALLBACK task_socket_receive( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_socket_receive( void *ctx )
 {
     struct socket_receive *r = ctx;
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     socket_receive( r->socket, r->buf, r->len, NULL, NULL, TRUE );
 
     release_object( &r->socket->hdr );
@@ -3576,13 +3682,13 @@ static DWORD socket_shutdown( struct socket *socket, USHORT status, const void *
     return ret;
 }
 
-static void CALLBACK task_socket_shutdown( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_socket_shutdown( void *ctx )
 {
     struct socket_shutdown *s = ctx;
 
     socket_shutdown( s->socket, s->status, s->reason, s->len, TRUE );
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     release_object( &s->socket->hdr );
     free( s );
 }
@@ -3677,13 +3783,13 @@ done:
     return ret;
 }
 
-static void CALLBACK task_socket_close( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+static void task_socket_close( void *ctx )
 {
     struct socket_shutdown *s = ctx;
 
     socket_close( s->socket, s->status, s->reason, s->len, TRUE );
 
-    TRACE("running %p\n", work);
+    TRACE("running %p\n", ctx);
     release_object( &s->socket->hdr );
     free( s );
 }
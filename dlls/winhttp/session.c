@@ -1163,6 +1163,7 @@ HINTERNET WINAPI WinHttpOpenRequest( HINTERNET hconnect, LPCWSTR verb, LPCWSTR o
 
     addref_object( &connect->hdr );
     request->connect = connect;
+    init_queue( &request->queue, &request->hdr, FALSE );
 
     request->resolve_timeout = connect->session->resolve_timeout;
     request->connect_timeout = connect->session->connect_timeout;
@@ -155,10 +155,17 @@ struct authinfo
     BOOL finished; /* finished authenticating */
 };
 
+/* tasks of a queue run in order on the winhttp thread pool, one at a time,
+ * or on a pool of their own for queues with a private pool */
 struct queue
 {
-    TP_POOL *pool;
+    SRWLOCK lock;
+    struct list tasks;
+    BOOL callback_running;
+    BOOL private_pool;
+    TP_POOL *pool; /* private pool, started on demand */
     TP_CALLBACK_ENVIRON env;
+    struct object_header *owner;
 };
 
 enum request_flags
@@ -319,7 +326,9 @@ BOOL free_handle( HINTERNET ) DECLSPEC_HIDDEN;
 
 void send_callback( struct object_header *, DWORD, LPVOID, DWORD ) DECLSPEC_HIDDEN;
 void close_connection( struct request * ) DECLSPEC_HIDDEN;
+void init_queue( struct queue *, struct object_header *, BOOL ) DECLSPEC_HIDDEN;
 void stop_queue( struct queue * ) DECLSPEC_HIDDEN;
+void release_task_pool( void ) DECLSPEC_HIDDEN;
 
 void netconn_close( struct netconn * ) DECLSPEC_HIDDEN;
 DWORD netconn_create( struct hostdata *, const struct sockaddr_storage *, int, struct netconn ** ) DECLSPEC_HIDDEN;
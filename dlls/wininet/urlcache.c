@@ -185,6 +185,7 @@ typedef struct
     char *cache_prefix; /* string that has to be prefixed for this container to be used */
     LPWSTR path; /* path to url container directory */
     HANDLE mapping; /* handle of file mapping */
+    urlcache_header *view; /* view of the mapping, kept between index locks */
     DWORD file_size; /* size of file when mapping was opened */
     HANDLE mutex; /* handle of mutex */
     DWORD default_entry_type;
@@ -644,7 +645,7 @@ static DWORD cache_container_open_index(cache_container *container, DWORD blocks
             UnmapViewOfFile(header);
             FreeUrlCacheSpaceW(container->path, 100, 0);
         }else if(header) {
-            UnmapViewOfFile(header);
+            container->view = header;
         }else {
             CloseHandle(container->mapping);
             container->mapping = NULL;
@@ -673,10 +674,26 @@ static DWORD cache_container_open_index(cache_container *container, DWORD blocks
  */
 static void cache_container_close_index(cache_container *pContainer)
 {
+    if (pContainer->view) UnmapViewOfFile(pContainer->view);
+    pContainer->view = NULL;
     CloseHandle(pContainer->mapping);
     pContainer->mapping = NULL;
 }
 
+/***********************************************************************
+ *           cache_container_map_view (Internal)
+ *
+ *  Returns the view of the index, mapping it if needed. The view stays
+ * mapped until the index is closed, so that locking the index doesn't
+ * need to map and unmap the file every time.
+ */
+static urlcache_header *cache_container_map_view(cache_container *container)
+{
+    if (!container->view)
+        container->view = MapViewOfFile(container->mapping, FILE_MAP_WRITE, 0, 0, 0);
+    return container->view;
+}
+
 static BOOL cache_containers_add(const char *cache_prefix, LPCWSTR path,
         DWORD default_entry_type, LPWSTR mutex_name)
 {
@@ -689,6 +706,7 @@ static BOOL cache_containers_add(const char *cache_prefix, LPCWSTR path,
     }
 
     pContainer->mapping = NULL;
+    pContainer->view = NULL;
     pContainer->file_size = 0;
     pContainer->default_entry_type = default_entry_type;
 
@@ -884,29 +902,24 @@ static BOOL cache_containers_enum(char *search_pattern, DWORD index, cache_conta
 static urlcache_header* cache_container_lock_index(cache_container *pContainer)
 {
     BYTE index;
-    LPVOID pIndexData;
     urlcache_header* pHeader;
     DWORD error;
 
     /* acquire mutex */
     WaitForSingleObject(pContainer->mutex, INFINITE);
 
-    pIndexData = MapViewOfFile(pContainer->mapping, FILE_MAP_WRITE, 0, 0, 0);
-
-    if (!pIndexData)
+    if (!(pHeader = cache_container_map_view(pContainer)))
     {
         ReleaseMutex(pContainer->mutex);
         ERR("Couldn't MapViewOfFile. Error: %d\n", GetLastError());
         return NULL;
     }
-    pHeader = (urlcache_header*)pIndexData;
 
     /* file has grown - we need to remap to prevent us getting
      * access violations when we try and access beyond the end
      * of the memory mapped file */
     if (pHeader->size != pContainer->file_size)
     {
-        UnmapViewOfFile( pHeader );
         cache_container_close_index(pContainer);
         error = cache_container_open_index(pContainer, MIN_BLOCK_NO);
         if (error != ERROR_SUCCESS)
@@ -915,15 +928,13 @@ static urlcache_header* cache_container_lock_index(cache_container *pContainer)
             SetLastError(error);
             return NULL;
         }
-        pIndexData = MapViewOfFile(pContainer->mapping, FILE_MAP_WRITE, 0, 0, 0);
 
-        if (!pIndexData)
+        if (!(pHeader = cache_container_map_view(pContainer)))
         {
             ReleaseMutex(pContainer->mutex);
             ERR("Couldn't MapViewOfFile. Error: %d\n", GetLastError());
             return NULL;
         }
-        pHeader = (urlcache_header*)pIndexData;
     }
 
     TRACE("Signature: %s, file size: %d bytes\n", pHeader->signature, pHeader->size);
@@ -942,9 +953,8 @@ static urlcache_header* cache_container_lock_index(cache_container *pContainer)
  */
 static BOOL cache_container_unlock_index(cache_container *pContainer, urlcache_header *pHeader)
 {
-    /* release mutex */
-    ReleaseMutex(pContainer->mutex);
-    return UnmapViewOfFile(pHeader);
+    /* release mutex, the view stays mapped */
+    return ReleaseMutex(pContainer->mutex);
 }
 
 /***********************************************************************
@@ -1173,16 +1183,21 @@ static DWORD cache_container_clean_index(cache_container *container, urlcache_he
         return ERROR_NOT_ENOUGH_MEMORY;
     }
 
+    /* keep the old view mapped, the caller still uses it if this fails */
+    container->view = NULL;
     cache_container_close_index(container);
     ret = cache_container_open_index(container, header->capacity_in_blocks*2);
-    if(ret != ERROR_SUCCESS)
+    if(ret == ERROR_SUCCESS && !cache_container_map_view(container))
+        ret = GetLastError();
+    if(ret != ERROR_SUCCESS) {
+        if(container->view)
+            UnmapViewOfFile(container->view);
+        container->view = *file_view;
         return ret;
-    header = MapViewOfFile(container->mapping, FILE_MAP_WRITE, 0, 0, 0);
-    if(!header)
-        return GetLastError();
+    }
 
     UnmapViewOfFile(*file_view);
-    *file_view = header;
+    *file_view = container->view;
     return ERROR_SUCCESS;
 }
 
@@ -3812,7 +3827,10 @@ BOOL WINAPI GetUrlCacheConfigInfoW(LPINTERNET_CACHE_CONFIG_INFOW info, LPDWORD s
     info->dwCacheSize = container->file_size / 1024;
     lstrcpynW(info->CachePath, container->path, MAX_PATH);
 
+    /* the view may be in use by another thread holding the index lock */
+    WaitForSingleObject(container->mutex, INFINITE);
     cache_container_close_index(container);
+    ReleaseMutex(container->mutex);
 
     TRACE("CachePath %s\n", debugstr_w(info->CachePath));
 
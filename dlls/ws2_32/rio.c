@@ -0,0 +1,699 @@
+/*
+ * Winsock Registered I/O extension
+ *
+ * Copyright (C) the Wine project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "ws2_32_private.h"
+#include "wine/list.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(winsock);
+
+/* Registered I/O is implemented on top of overlapped WSARecv/WSASend. Each request
+ * has its own event, with the low bit set in the OVERLAPPED structure so that no
+ * packet is queued to a completion port the application may have associated with
+ * the socket. A thread pool wait on that event stores the result in the completion
+ * queue ring, from which it is dequeued without any server round trip. */
+
+struct rio_buffer
+{
+    char  *data;
+    ULONG  size;
+};
+
+struct rio_cq
+{
+    LONG                        refcount;  /* held by the application and by the request queues */
+    CRITICAL_SECTION            cs;
+    RIORESULT                  *results;
+    ULONG                       size;      /* ring size */
+    ULONG                       head;      /* index of the first result */
+    ULONG                       count;     /* number of queued results */
+    ULONG                       reserved;  /* entries reserved by the request queues */
+    BOOL                        corrupt;   /* results have been lost */
+    BOOL                        armed;     /* RIONotify() called, waiting for a result */
+    RIO_NOTIFICATION_COMPLETION notify;
+};
+
+struct rio_rq
+{
+    struct list    entry;
+    LONG           refcount;
+    SOCKET         socket;
+    ULONGLONG      context;
+    struct rio_cq *recv_cq;
+    struct rio_cq *send_cq;
+    ULONG          max_recv;
+    ULONG          max_send;
+    ULONG          pending_recv;
+    ULONG          pending_send;
+    struct list    free_requests;
+};
+
+struct rio_request
+{
+    OVERLAPPED     ovl;
+    HANDLE         event;
+    TP_WAIT       *wait;
+    struct list    entry;
+    struct rio_rq *rq;
+    ULONGLONG      context;
+    BOOL           send;
+    BOOL           notify;
+    int            addr_len;
+};
+
+static struct list rio_queues = LIST_INIT( rio_queues );
+DECLARE_CRITICAL_SECTION(rio_cs);
+
+static struct rio_cq *impl_from_RIO_CQ( RIO_CQ cq )
+{
+    return (struct rio_cq *)cq;
+}
+
+static struct rio_rq *impl_from_RIO_RQ( RIO_RQ rq )
+{
+    return (struct rio_rq *)rq;
+}
+
+static void release_rio_cq( struct rio_cq *cq )
+{
+    if (InterlockedDecrement( &cq->refcount )) return;
+
+    cq->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &cq->cs );
+    free( cq->results );
+    free( cq );
+}
+
+static void release_rio_rq( struct rio_rq *rq )
+{
+    struct rio_request *req, *next;
+
+    if (InterlockedDecrement( &rq->refcount )) return;
+
+    LIST_FOR_EACH_ENTRY_SAFE( req, next, &rq->free_requests, struct rio_request, entry )
+    {
+        CloseThreadpoolWait( req->wait );
+        CloseHandle( req->event );
+        free( req );
+    }
+    release_rio_cq( rq->recv_cq );
+    release_rio_cq( rq->send_cq );
+    free( rq );
+}
+
+static void fire_rio_notification( const RIO_NOTIFICATION_COMPLETION *notify )
+{
+    if (notify->Type == RIO_EVENT_COMPLETION)
+        SetEvent( notify->u.Event.EventHandle );
+    else
+        PostQueuedCompletionStatus( notify->u.Iocp.IocpHandle, 0, (ULONG_PTR)notify->u.Iocp.CompletionKey,
+                                    notify->u.Iocp.Overlapped );
+}
+
+static void add_rio_result( struct rio_cq *cq, const RIORESULT *result, BOOL notify )
+{
+    BOOL fire = FALSE;
+
+    EnterCriticalSection( &cq->cs );
+    if (cq->count < cq->size)
+    {
+        cq->results[(cq->head + cq->count) % cq->size] = *result;
+        cq->count++;
+    }
+    else
+    {
+        ERR( "completion queue %p overflow\n", cq );
+        cq->corrupt = TRUE;
+    }
+    if (notify && cq->armed)
+    {
+        cq->armed = FALSE;
+        fire = TRUE;
+    }
+    LeaveCriticalSection( &cq->cs );
+
+    if (fire) fire_rio_notification( &cq->notify );
+}
+
+static void free_rio_request( struct rio_request *req )
+{
+    struct rio_rq *rq = req->rq;
+
+    EnterCriticalSection( &rio_cs );
+    if (req->send) rq->pending_send--;
+    else rq->pending_recv--;
+    list_add_head( &rq->free_requests, &req->entry );
+    LeaveCriticalSection( &rio_cs );
+    release_rio_rq( rq );
+}
+
+static void CALLBACK rio_request_completion( TP_CALLBACK_INSTANCE *instance, void *context,
+                                             TP_WAIT *wait, TP_WAIT_RESULT wait_result )
+{
+    struct rio_request *req = context;
+    struct rio_rq *rq = req->rq;
+    RIORESULT result;
+
+    TRACE( "rq %p request %p status %#lx size %lu\n", rq, req, req->ovl.Internal, req->ovl.InternalHigh );
+
+    result.Status = NtStatusToWSAError( req->ovl.Internal );
+    result.BytesTransferred = req->ovl.InternalHigh;
+    result.SocketContext = rq->context;
+    result.RequestContext = req->context;
+    add_rio_result( req->send ? rq->send_cq : rq->recv_cq, &result, req->notify );
+    free_rio_request( req );
+}
+
+static BOOL get_rio_buffer( const RIO_BUF *buf, WSABUF *wsabuf )
+{
+    const struct rio_buffer *buffer = (const struct rio_buffer *)buf->BufferId;
+
+    if (!buffer || buf->BufferId == RIO_INVALID_BUFFERID ||
+        buf->Offset > buffer->size || buf->Length > buffer->size - buf->Offset)
+        return FALSE;
+    wsabuf->buf = buffer->data + buf->Offset;
+    wsabuf->len = buf->Length;
+    return TRUE;
+}
+
+static struct rio_request *alloc_rio_request( struct rio_rq *rq, BOOL send, DWORD flags, void *context )
+{
+    struct rio_request *req = NULL;
+    struct list *ptr;
+
+    EnterCriticalSection( &rio_cs );
+    if (send ? rq->pending_send >= rq->max_send : rq->pending_recv >= rq->max_recv)
+    {
+        LeaveCriticalSection( &rio_cs );
+        SetLastError( WSAENOBUFS );
+        return NULL;
+    }
+    if ((ptr = list_head( &rq->free_requests )))
+    {
+        req = LIST_ENTRY( ptr, struct rio_request, entry );
+        list_remove( &req->entry );
+    }
+    else if (!(req = malloc( sizeof(*req) )) ||
+             !(req->event = CreateEventW( NULL, FALSE, FALSE, NULL )))
+    {
+        LeaveCriticalSection( &rio_cs );
+        free( req );
+        SetLastError( WSAENOBUFS );
+        return NULL;
+    }
+    else if (!(req->wait = CreateThreadpoolWait( rio_request_completion, req, NULL )))
+    {
+        LeaveCriticalSection( &rio_cs );
+        CloseHandle( req->event );
+        free( req );
+        SetLastError( WSAENOBUFS );
+        return NULL;
+    }
+    if (send) rq->pending_send++;
+    else rq->pending_recv++;
+    LeaveCriticalSection( &rio_cs );
+
+    memset( &req->ovl, 0, sizeof(req->ovl) );
+    req->ovl.hEvent = (HANDLE)((ULONG_PTR)req->event | 1);  /* don't queue a completion packet */
+    req->rq = rq;
+    req->context = (ULONG_PTR)context;
+    req->send = send;
+    req->notify = !(flags & RIO_MSG_DONT_NOTIFY);
+    InterlockedIncrement( &rq->refcount );
+    SetThreadpoolWait( req->wait, req->event, NULL );
+    return req;
+}
+
+/* release a request whose I/O failed synchronously and will never signal its event */
+static void cancel_rio_request( struct rio_request *req )
+{
+    SetThreadpoolWait( req->wait, NULL, NULL );
+    free_rio_request( req );
+}
+
+static BOOL check_rio_request( ULONG count, DWORD flags )
+{
+    if (flags & ~(RIO_MSG_DONT_NOTIFY | RIO_MSG_DEFER | RIO_MSG_WAITALL | RIO_MSG_COMMIT_ONLY))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (count > 1 || (!count && !(flags & RIO_MSG_COMMIT_ONLY)))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL rio_receive( struct rio_rq *rq, RIO_BUF *data, ULONG count, RIO_BUF *remote_addr,
+                         DWORD flags, void *context )
+{
+    struct rio_request *req;
+    WSABUF wsabuf, addr;
+    DWORD recv_flags;
+    int ret;
+
+    if (!rq)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (!check_rio_request( count, flags )) return FALSE;
+    /* requests are never deferred, so there's nothing to commit */
+    if (!count) return TRUE;
+
+    if (!get_rio_buffer( data, &wsabuf ) || (remote_addr && !get_rio_buffer( remote_addr, &addr )))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (!(req = alloc_rio_request( rq, FALSE, flags, context ))) return FALSE;
+
+    recv_flags = (flags & RIO_MSG_WAITALL) ? MSG_WAITALL : 0;
+    if (remote_addr)
+    {
+        req->addr_len = addr.len;
+        ret = WSARecvFrom( rq->socket, &wsabuf, 1, NULL, &recv_flags, (struct sockaddr *)addr.buf,
+                           &req->addr_len, &req->ovl, NULL );
+    }
+    else ret = WSARecv( rq->socket, &wsabuf, 1, NULL, &recv_flags, &req->ovl, NULL );
+
+    if (ret && WSAGetLastError() != WSA_IO_PENDING)
+    {
+        cancel_rio_request( req );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL rio_send( struct rio_rq *rq, RIO_BUF *data, ULONG count, RIO_BUF *remote_addr,
+                      DWORD flags, void *context )
+{
+    struct rio_request *req;
+    WSABUF wsabuf, addr;
+    int ret;
+
+    if (!rq)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (!check_rio_request( count, flags )) return FALSE;
+    if (!count) return TRUE;
+
+    if (!get_rio_buffer( data, &wsabuf ) || (remote_addr && !get_rio_buffer( remote_addr, &addr )))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (!(req = alloc_rio_request( rq, TRUE, flags, context ))) return FALSE;
+
+    if (remote_addr)
+        ret = WSASendTo( rq->socket, &wsabuf, 1, NULL, 0, (struct sockaddr *)addr.buf,
+                         addr.len, &req->ovl, NULL );
+    else
+        ret = WSASend( rq->socket, &wsabuf, 1, NULL, 0, &req->ovl, NULL );
+
+    if (ret && WSAGetLastError() != WSA_IO_PENDING)
+    {
+        cancel_rio_request( req );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/***********************************************************************
+ *     RIOReceive
+ */
+static BOOL WINAPI WS2_RIOReceive( RIO_RQ queue, RIO_BUF *data, ULONG count, DWORD flags, void *context )
+{
+    TRACE( "%p, %p, %u, %#x, %p\n", queue, data, count, flags, context );
+
+    return rio_receive( impl_from_RIO_RQ( queue ), data, count, NULL, flags, context );
+}
+
+/***********************************************************************
+ *     RIOReceiveEx
+ */
+static int WINAPI WS2_RIOReceiveEx( RIO_RQ queue, RIO_BUF *data, ULONG count, RIO_BUF *local_addr,
+                                    RIO_BUF *remote_addr, RIO_BUF *control, RIO_BUF *msg_flags,
+                                    DWORD flags, void *context )
+{
+    TRACE( "%p, %p, %u, %p, %p, %p, %p, %#x, %p\n", queue, data, count, local_addr, remote_addr,
+           control, msg_flags, flags, context );
+
+    if (local_addr || control || msg_flags)
+        FIXME( "local address, control and flags buffers not supported\n" );
+
+    return rio_receive( impl_from_RIO_RQ( queue ), data, count, remote_addr, flags, context );
+}
+
+/***********************************************************************
+ *     RIOSend
+ */
+static BOOL WINAPI WS2_RIOSend( RIO_RQ queue, RIO_BUF *data, ULONG count, DWORD flags, void *context )
+{
+    TRACE( "%p, %p, %u, %#x, %p\n", queue, data, count, flags, context );
+
+    return rio_send( impl_from_RIO_RQ( queue ), data, count, NULL, flags, context );
+}
+
+/***********************************************************************
+ *     RIOSendEx
+ */
+static BOOL WINAPI WS2_RIOSendEx( RIO_RQ queue, RIO_BUF *data, ULONG count, RIO_BUF *local_addr,
+                                  RIO_BUF *remote_addr, RIO_BUF *control, RIO_BUF *msg_flags,
+                                  DWORD flags, void *context )
+{
+    TRACE( "%p, %p, %u, %p, %p, %p, %p, %#x, %p\n", queue, data, count, local_addr, remote_addr,
+           control, msg_flags, flags, context );
+
+    if (local_addr || control || msg_flags)
+        FIXME( "local address, control and flags buffers not supported\n" );
+
+    return rio_send( impl_from_RIO_RQ( queue ), data, count, remote_addr, flags, context );
+}
+
+/***********************************************************************
+ *     RIOCloseCompletionQueue
+ */
+static void WINAPI WS2_RIOCloseCompletionQueue( RIO_CQ queue )
+{
+    struct rio_cq *cq = impl_from_RIO_CQ( queue );
+
+    TRACE( "%p\n", queue );
+
+    /* request queues using it, and their pending requests, keep it alive */
+    if (cq) release_rio_cq( cq );
+}
+
+/***********************************************************************
+ *     RIOCreateCompletionQueue
+ */
+static RIO_CQ WINAPI WS2_RIOCreateCompletionQueue( DWORD size, RIO_NOTIFICATION_COMPLETION *notify )
+{
+    struct rio_cq *cq;
+
+    TRACE( "%u, %p\n", size, notify );
+
+    if (!size || size > RIO_MAX_CQ_SIZE ||
+        (notify && notify->Type != RIO_EVENT_COMPLETION && notify->Type != RIO_IOCP_COMPLETION))
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_CQ;
+    }
+
+    if (!(cq = calloc( 1, sizeof(*cq) )) || !(cq->results = malloc( size * sizeof(*cq->results) )))
+    {
+        free( cq );
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_CQ;
+    }
+    cq->refcount = 1;
+    cq->size = size;
+    if (notify) cq->notify = *notify;
+    InitializeCriticalSection( &cq->cs );
+    cq->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": rio_cq.cs");
+
+    TRACE( "returning %p\n", cq );
+    return (RIO_CQ)cq;
+}
+
+/***********************************************************************
+ *     RIOCreateRequestQueue
+ */
+static RIO_RQ WINAPI WS2_RIOCreateRequestQueue( SOCKET s, ULONG max_recv, ULONG max_recv_buffers,
+                                                ULONG max_send, ULONG max_send_buffers,
+                                                RIO_CQ recv_queue, RIO_CQ send_queue, void *context )
+{
+    struct rio_cq *recv_cq = impl_from_RIO_CQ( recv_queue ), *send_cq = impl_from_RIO_CQ( send_queue );
+    struct rio_rq *rq;
+
+    TRACE( "%#lx, %u, %u, %u, %u, %p, %p, %p\n", s, max_recv, max_recv_buffers, max_send,
+           max_send_buffers, recv_queue, send_queue, context );
+
+    if (!recv_cq || !send_cq || max_recv_buffers > 1 || max_send_buffers > 1)
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_RQ;
+    }
+
+    if (!(rq = calloc( 1, sizeof(*rq) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_RQ;
+    }
+    rq->refcount = 1;
+    rq->socket = s;
+    rq->context = (ULONG_PTR)context;
+    rq->recv_cq = recv_cq;
+    rq->send_cq = send_cq;
+    rq->max_recv = max_recv;
+    rq->max_send = max_send;
+    list_init( &rq->free_requests );
+
+    /* make sure that the completion queues can hold all the outstanding requests */
+    EnterCriticalSection( &rio_cs );
+    if (recv_cq->reserved + max_recv + (recv_cq == send_cq ? max_send : 0) > recv_cq->size ||
+        send_cq->reserved + max_send + (recv_cq == send_cq ? max_recv : 0) > send_cq->size)
+    {
+        LeaveCriticalSection( &rio_cs );
+        free( rq );
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_RQ;
+    }
+    InterlockedIncrement( &recv_cq->refcount );
+    InterlockedIncrement( &send_cq->refcount );
+    recv_cq->reserved += max_recv;
+    send_cq->reserved += max_send;
+    list_add_tail( &rio_queues, &rq->entry );
+    LeaveCriticalSection( &rio_cs );
+
+    TRACE( "returning %p\n", rq );
+    return (RIO_RQ)rq;
+}
+
+/***********************************************************************
+ *     RIODequeueCompletion
+ */
+static ULONG WINAPI WS2_RIODequeueCompletion( RIO_CQ queue, RIORESULT *results, ULONG size )
+{
+    struct rio_cq *cq = impl_from_RIO_CQ( queue );
+    ULONG i, count;
+
+    TRACE( "%p, %p, %u\n", queue, results, size );
+
+    if (!cq || !results) return RIO_CORRUPT_CQ;
+
+    EnterCriticalSection( &cq->cs );
+    if (cq->corrupt)
+    {
+        LeaveCriticalSection( &cq->cs );
+        return RIO_CORRUPT_CQ;
+    }
+    count = min( size, cq->count );
+    for (i = 0; i < count; i++)
+        results[i] = cq->results[(cq->head + i) % cq->size];
+    cq->head = (cq->head + count) % cq->size;
+    cq->count -= count;
+    LeaveCriticalSection( &cq->cs );
+
+    TRACE( "returning %u results\n", count );
+    return count;
+}
+
+/***********************************************************************
+ *     RIODeregisterBuffer
+ */
+static void WINAPI WS2_RIODeregisterBuffer( RIO_BUFFERID id )
+{
+    TRACE( "%p\n", id );
+
+    if (id == RIO_INVALID_BUFFERID) return;
+    free( id );
+}
+
+/***********************************************************************
+ *     RIONotify
+ */
+static int WINAPI WS2_RIONotify( RIO_CQ queue )
+{
+    struct rio_cq *cq = impl_from_RIO_CQ( queue );
+    BOOL fire = FALSE;
+
+    TRACE( "%p\n", queue );
+
+    if (!cq || !cq->notify.Type) return WSAEINVAL;
+
+    if (cq->notify.Type == RIO_EVENT_COMPLETION && cq->notify.u.Event.NotifyReset)
+        ResetEvent( cq->notify.u.Event.EventHandle );
+
+    EnterCriticalSection( &cq->cs );
+    if (cq->armed)
+    {
+        LeaveCriticalSection( &cq->cs );
+        return WSAEALREADY;
+    }
+    if (cq->count) fire = TRUE;
+    else cq->armed = TRUE;
+    LeaveCriticalSection( &cq->cs );
+
+    if (fire) fire_rio_notification( &cq->notify );
+    return ERROR_SUCCESS;
+}
+
+/***********************************************************************
+ *     RIORegisterBuffer
+ */
+static RIO_BUFFERID WINAPI WS2_RIORegisterBuffer( char *data, DWORD size )
+{
+    struct rio_buffer *buffer;
+
+    TRACE( "%p, %u\n", data, size );
+
+    if (!data)
+    {
+        SetLastError( WSAEFAULT );
+        return RIO_INVALID_BUFFERID;
+    }
+    if (!(buffer = malloc( sizeof(*buffer) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_BUFFERID;
+    }
+    buffer->data = data;
+    buffer->size = size;
+    return (RIO_BUFFERID)buffer;
+}
+
+/***********************************************************************
+ *     RIOResizeCompletionQueue
+ */
+static BOOL WINAPI WS2_RIOResizeCompletionQueue( RIO_CQ queue, DWORD size )
+{
+    struct rio_cq *cq = impl_from_RIO_CQ( queue );
+    RIORESULT *results;
+    ULONG i;
+
+    TRACE( "%p, %u\n", queue, size );
+
+    if (!cq || !size || size > RIO_MAX_CQ_SIZE)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &rio_cs );
+    EnterCriticalSection( &cq->cs );
+    if (size < cq->count || size < cq->reserved)
+    {
+        LeaveCriticalSection( &cq->cs );
+        LeaveCriticalSection( &rio_cs );
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (!(results = malloc( size * sizeof(*results) )))
+    {
+        LeaveCriticalSection( &cq->cs );
+        LeaveCriticalSection( &rio_cs );
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+    for (i = 0; i < cq->count; i++) results[i] = cq->results[(cq->head + i) % cq->size];
+    free( cq->results );
+    cq->results = results;
+    cq->head = 0;
+    cq->size = size;
+    LeaveCriticalSection( &cq->cs );
+    LeaveCriticalSection( &rio_cs );
+    return TRUE;
+}
+
+/***********************************************************************
+ *     RIOResizeRequestQueue
+ */
+static BOOL WINAPI WS2_RIOResizeRequestQueue( RIO_RQ queue, DWORD max_recv, DWORD max_send )
+{
+    struct rio_rq *rq = impl_from_RIO_RQ( queue );
+    BOOL ret = FALSE;
+
+    TRACE( "%p, %u, %u\n", queue, max_recv, max_send );
+
+    if (!rq)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &rio_cs );
+    if (max_recv < rq->pending_recv || max_send < rq->pending_send)
+        SetLastError( WSAEINVAL );
+    else if (rq->recv_cq->reserved - rq->max_recv + max_recv > rq->recv_cq->size ||
+             rq->send_cq->reserved - rq->max_send + max_send > rq->send_cq->size)
+        SetLastError( WSAENOBUFS );
+    else
+    {
+        rq->recv_cq->reserved = rq->recv_cq->reserved - rq->max_recv + max_recv;
+        rq->send_cq->reserved = rq->send_cq->reserved - rq->max_send + max_send;
+        rq->max_recv = max_recv;
+        rq->max_send = max_send;
+        ret = TRUE;
+    }
+    LeaveCriticalSection( &rio_cs );
+    return ret;
+}
+
+/* called when a socket is closed, to release its request queue */
+void rio_close_socket( SOCKET s )
+{
+    struct rio_rq *rq;
+
+    EnterCriticalSection( &rio_cs );
+    LIST_FOR_EACH_ENTRY( rq, &rio_queues, struct rio_rq, entry )
+    {
+        if (rq->socket != s) continue;
+        list_remove( &rq->entry );
+        rq->recv_cq->reserved -= rq->max_recv;
+        rq->send_cq->reserved -= rq->max_send;
+        LeaveCriticalSection( &rio_cs );
+        /* pending requests keep a reference until they are completed */
+        release_rio_rq( rq );
+        return;
+    }
+    LeaveCriticalSection( &rio_cs );
+}
+
+const RIO_EXTENSION_FUNCTION_TABLE rio_extension_functions =
+{
+    sizeof(RIO_EXTENSION_FUNCTION_TABLE),
+    WS2_RIOReceive,
+    WS2_RIOReceiveEx,
+    WS2_RIOSend,
+    WS2_RIOSendEx,
+    WS2_RIOCloseCompletionQueue,
+    WS2_RIOCreateCompletionQueue,
+    WS2_RIOCreateRequestQueue,
+    WS2_RIODequeueCompletion,
+    WS2_RIODeregisterBuffer,
+    WS2_RIONotify,
+    WS2_RIORegisterBuffer,
+    WS2_RIOResizeCompletionQueue,
+    WS2_RIOResizeRequestQueue,
+};
@@ -427,7 +427,7 @@ static FARPROC blocking_hook = (FARPROC)WSA_DefaultBlockingHook;
 /* function prototypes */
 static int ws_protocol_info(SOCKET s, int unicode, WSAPROTOCOL_INFOW *buffer, int *size);
 
-static DWORD NtStatusToWSAError( NTSTATUS status )
+DWORD NtStatusToWSAError( NTSTATUS status )
 {
     static const struct
     {
@@ -1162,6 +1162,7 @@ int WINAPI closesocket( SOCKET s )
         return -1;
     }
 
+    rio_close_socket( s );
     CloseHandle( (HANDLE)s );
     return 0;
 }
@@ -1807,6 +1808,7 @@ static const char *debugstr_wsaioctl(DWORD code)
         IOCTL_NAME(SIO_FLUSH);
         IOCTL_NAME(SIO_GET_BROADCAST_ADDRESS);
         IOCTL_NAME(SIO_GET_EXTENSION_FUNCTION_POINTER);
+        IOCTL_NAME(SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER);
         IOCTL_NAME(SIO_GET_GROUP_QOS);
         IOCTL_NAME(SIO_GET_INTERFACE_LIST);
         /* IOCTL_NAME(SIO_GET_INTERFACE_LIST_EX); */
@@ -2140,6 +2142,35 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
         return -1;
     }
 
+    case SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER:
+    {
+        static const GUID rio_guid = WSAID_MULTIPLE_RIO;
+        NTSTATUS status = STATUS_SUCCESS;
+        DWORD ret;
+
+        if (in_size < sizeof(GUID) || !IsEqualGUID( &rio_guid, in_buff ))
+        {
+            FIXME( "SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER %s: stub\n",
+                   in_size >= sizeof(GUID) ? debugstr_guid( in_buff ) : "(invalid)" );
+            SetLastError( WSAEINVAL );
+            return -1;
+        }
+        if (out_size < sizeof(RIO_EXTENSION_FUNCTION_TABLE))
+        {
+            SetLastError( WSAEFAULT );
+            return -1;
+        }
+
+        TRACE( "returning RIO function table\n" );
+        memcpy( out_buff, &rio_extension_functions, sizeof(rio_extension_functions) );
+
+        ret = server_ioctl_sock( s, IOCTL_AFD_WINE_COMPLETE_ASYNC, &status, sizeof(status),
+                                 NULL, 0, ret_size, overlapped, completion );
+        *ret_size = sizeof(rio_extension_functions);
+        SetLastError( ret );
+        return ret ? -1 : 0;
+    }
+
     case SIO_KEEPALIVE_VALS:
     {
         DWORD ret;
@@ -11512,6 +11512,101 @@ static void test_timeout(void)
     CloseHandle(overlapped.hEvent);
 }
 
+static void test_rio(void)
+{
+    static const GUID rio_guid = WSAID_MULTIPLE_RIO;
+    struct sockaddr_in addr = {.sin_family = AF_INET};
+    RIO_NOTIFICATION_COMPLETION notify;
+    RIO_EXTENSION_FUNCTION_TABLE rio;
+    RIO_BUFFERID buffer_id;
+    RIORESULT results[4];
+    SOCKET client, server;
+    char buffer[64];
+    ULONG count;
+    HANDLE event;
+    RIO_BUF buf;
+    DWORD size;
+    RIO_CQ cq;
+    RIO_RQ rq;
+    int ret, len;
+
+    server = WSASocketW(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+    ok(server != INVALID_SOCKET, "got error %u\n", WSAGetLastError());
+
+    memset(&rio, 0, sizeof(rio));
+    ret = WSAIoctl(server, SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER, (void *)&rio_guid, sizeof(rio_guid),
+                   &rio, sizeof(rio), &size, NULL, NULL);
+    if (ret)
+    {
+        win_skip("Registered I/O is not supported.\n");
+        closesocket(server);
+        return;
+    }
+    ok(size == sizeof(rio), "got size %u\n", size);
+    ok(rio.cbSize == sizeof(rio), "got table size %u\n", rio.cbSize);
+
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ret = bind(server, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(server, (struct sockaddr *)&addr, &len);
+    ok(!ret, "got error %u\n", WSAGetLastError());
+
+    event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    notify.Type = RIO_EVENT_COMPLETION;
+    notify.Event.EventHandle = event;
+    notify.Event.NotifyReset = FALSE;
+    cq = rio.RIOCreateCompletionQueue(4, &notify);
+    ok(cq != RIO_INVALID_CQ, "got error %u\n", WSAGetLastError());
+
+    rq = rio.RIOCreateRequestQueue(server, 1, 1, 1, 1, cq, cq, (void *)0xdead);
+    ok(rq != RIO_INVALID_RQ, "got error %u\n", WSAGetLastError());
+
+    buffer_id = rio.RIORegisterBuffer(buffer, sizeof(buffer));
+    ok(buffer_id != RIO_INVALID_BUFFERID, "got error %u\n", WSAGetLastError());
+
+    memset(buffer, 0, sizeof(buffer));
+    buf.BufferId = buffer_id;
+    buf.Offset = 8;
+    buf.Length = 16;
+    ret = rio.RIOReceive(rq, &buf, 1, 0, (void *)0xbeef);
+    ok(ret, "got error %u\n", WSAGetLastError());
+
+    count = rio.RIODequeueCompletion(cq, results, ARRAY_SIZE(results));
+    ok(!count, "got %u results\n", count);
+
+    ret = rio.RIONotify(cq);
+    ok(!ret, "got %d\n", ret);
+    ret = rio.RIONotify(cq);
+    ok(ret == WSAEALREADY, "got %d\n", ret);
+
+    client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ok(client != INVALID_SOCKET, "got error %u\n", WSAGetLastError());
+    ret = sendto(client, "datagram", 8, 0, (struct sockaddr *)&addr, sizeof(addr));
+    ok(ret == 8, "got %d\n", ret);
+
+    ret = WaitForSingleObject(event, 1000);
+    ok(!ret, "wait failed\n");
+
+    memset(results, 0xcc, sizeof(results));
+    count = rio.RIODequeueCompletion(cq, results, ARRAY_SIZE(results));
+    ok(count == 1, "got %u results\n", count);
+    ok(!results[0].Status, "got status %d\n", results[0].Status);
+    ok(results[0].BytesTransferred == 8, "got size %u\n", results[0].BytesTransferred);
+    ok(results[0].SocketContext == 0xdead, "got socket context %s\n", wine_dbgstr_longlong(results[0].SocketContext));
+    ok(results[0].RequestContext == 0xbeef, "got request context %s\n", wine_dbgstr_longlong(results[0].RequestContext));
+    ok(!memcmp(buffer + 8, "datagram", 8), "got %s\n", debugstr_an(buffer + 8, 8));
+
+    count = rio.RIODequeueCompletion(cq, results, ARRAY_SIZE(results));
+    ok(!count, "got %u results\n", count);
+
+    closesocket(client);
+    closesocket(server);
+    rio.RIODeregisterBuffer(buffer_id);
+    rio.RIOCloseCompletionQueue(cq);
+    CloseHandle(event);
+}
+
 static void test_so_debug(void)
 {
     int ret, len;
@@ -11943,6 +12038,7 @@ START_TEST( sock )
     test_nonblocking_async_recv();
     test_empty_recv();
     test_timeout();
+    test_rio();
 
     /* this is an io heavy test, do it at the end so the kernel doesn't start dropping packets */
     test_send();
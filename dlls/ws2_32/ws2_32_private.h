@@ -62,6 +62,10 @@
 static const char magic_loopback_addr[] = {127, 12, 34, 56};
 
 const char *debugstr_sockaddr( const struct sockaddr *addr ) DECLSPEC_HIDDEN;
+DWORD NtStatusToWSAError( NTSTATUS status ) DECLSPEC_HIDDEN;
+
+extern const RIO_EXTENSION_FUNCTION_TABLE rio_extension_functions DECLSPEC_HIDDEN;
+void rio_close_socket( SOCKET s ) DECLSPEC_HIDDEN;
 
 struct per_thread_data
 {
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) the Wine project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+#ifndef _MSWSOCKDEF_
+#define _MSWSOCKDEF_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RIO_BUFFERID_t *RIO_BUFFERID, **PRIO_BUFFERID;
+typedef struct RIO_CQ_t *RIO_CQ, **PRIO_CQ;
+typedef struct RIO_RQ_t *RIO_RQ, **PRIO_RQ;
+
+typedef struct _RIORESULT
+{
+    LONG      Status;
+    ULONG     BytesTransferred;
+    ULONGLONG SocketContext;
+    ULONGLONG RequestContext;
+} RIORESULT, *PRIORESULT;
+
+typedef struct _RIO_BUF
+{
+    RIO_BUFFERID BufferId;
+    ULONG        Offset;
+    ULONG        Length;
+} RIO_BUF, *PRIO_BUF;
+
+#define RIO_MSG_DONT_NOTIFY   0x00000001
+#define RIO_MSG_DEFER         0x00000002
+#define RIO_MSG_WAITALL       0x00000004
+#define RIO_MSG_COMMIT_ONLY   0x00000008
+
+#define RIO_INVALID_BUFFERID  ((RIO_BUFFERID)(ULONG_PTR)0xffffffff)
+#define RIO_INVALID_CQ        ((RIO_CQ)0)
+#define RIO_INVALID_RQ        ((RIO_RQ)0)
+
+#define RIO_MAX_CQ_SIZE       0x8000000
+#define RIO_CORRUPT_CQ        0xffffffff
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MSWSOCKDEF_ */
@@ -122,6 +122,14 @@ union win_sockaddr
 
 static struct list poll_list = LIST_INIT( poll_list );
 
+struct poll_entry
+{
+    struct list entry;          /* entry in the socket's list of polls */
+    struct poll_req *req;       /* request this entry belongs to */
+    struct sock *sock;
+    int flags;
+};
+
 struct poll_req
 {
     struct list entry;
@@ -131,11 +139,7 @@ struct poll_req
     int exclusive;
     unsigned int count;
     struct poll_socket_output *output;
-    struct
-    {
-        struct sock *sock;
-        int flags;
-    } sockets[1];
+    struct poll_entry sockets[1];
 };
 
 struct accept_req
@@ -207,6 +211,7 @@ struct sock
     struct accept_req  *accept_recv_req; /* pending accept-into request which will recv on this socket */
     struct connect_req *connect_req; /* pending connection request */
     struct poll_req    *main_poll;   /* main poll */
+    struct list         poll_list;   /* list of poll entries waiting on this socket */
     union win_sockaddr  addr;        /* socket name */
     int                 addr_len;    /* socket name length */
     unsigned int        rcvbuf;      /* advisory recv buffer size */
@@ -791,7 +796,10 @@ static void free_poll_req( void *private )
     if (req->timeout) remove_timeout_user( req->timeout );
 
     for (i = 0; i < req->count; ++i)
+    {
+        list_remove( &req->sockets[i].entry );
         release_object( req->sockets[i].sock );
+    }
     release_object( req->async );
     release_object( req->iosb );
     list_remove( &req->entry );
@@ -847,6 +855,10 @@ static void complete_async_poll( struct poll_req *req, unsigned int status )
 
         if (sock->main_poll == req)
             sock->main_poll = NULL;
+
+        /* the request is done, stop dispatching events to it */
+        list_remove( &req->sockets[i].entry );
+        list_init( &req->sockets[i].entry );
     }
 
     /* pass 0 as result; client will set actual result size */
@@ -854,32 +866,41 @@ static void complete_async_poll( struct poll_req *req, unsigned int status )
     async_request_complete( req->async, status, 0, req->count * sizeof(*output), output );
 }
 
-static void complete_async_polls( struct sock *sock, int event, int error )
+/* find the first pending poll entry of a socket interested in the given flags,
+ * or the first pending one at all if flags is 0 */
+static struct poll_entry *find_pending_poll( struct sock *sock, int flags )
 {
-    int flags = get_poll_flags( sock, event );
-    struct poll_req *req, *next;
+    struct poll_entry *poll;
 
-    LIST_FOR_EACH_ENTRY_SAFE( req, next, &poll_list, struct poll_req, entry )
+    LIST_FOR_EACH_ENTRY( poll, &sock->poll_list, struct poll_entry, entry )
     {
-        unsigned int i;
+        if (poll->req->iosb->status != STATUS_PENDING) continue;
+        if (!flags || (poll->flags & flags)) return poll;
+    }
+    return NULL;
+}
 
-        if (req->iosb->status != STATUS_PENDING) continue;
+static void complete_async_polls( struct sock *sock, int event, int error )
+{
+    int flags = get_poll_flags( sock, event );
+    struct poll_entry *poll;
 
-        for (i = 0; i < req->count; ++i)
-        {
-            if (req->sockets[i].sock != sock) continue;
-            if (!(req->sockets[i].flags & flags)) continue;
+    if (!flags) return;
 
-            if (debug_level)
-                fprintf( stderr, "completing poll for socket %p, wanted %#x got %#x\n",
-                         sock, req->sockets[i].flags, flags );
+    /* completing a request unlinks all of its entries, so restart the lookup every time */
+    while ((poll = find_pending_poll( sock, flags )))
+    {
+        struct poll_req *req = poll->req;
+        unsigned int i = poll - req->sockets;
 
-            req->output[i].flags = req->sockets[i].flags & flags;
-            req->output[i].status = sock_get_ntstatus( error );
+        if (debug_level)
+            fprintf( stderr, "completing poll for socket %p, wanted %#x got %#x\n",
+                     sock, poll->flags, flags );
 
-            complete_async_poll( req, STATUS_SUCCESS );
-            break;
-        }
+        req->output[i].flags = poll->flags & flags;
+        req->output[i].status = sock_get_ntstatus( error );
+
+        complete_async_poll( req, STATUS_SUCCESS );
     }
 }
 
@@ -1137,7 +1158,7 @@ static int sock_get_poll_events( struct fd *fd )
 {
     struct sock *sock = get_fd_user( fd );
     unsigned int mask = sock->mask & ~sock->reported_events;
-    struct poll_req *req;
+    struct poll_entry *poll;
     int ev = 0;
 
     assert( sock->obj.ops == &sock_ops );
@@ -1218,17 +1239,8 @@ static int sock_get_poll_events( struct fd *fd )
         break;
     }
 
-    LIST_FOR_EACH_ENTRY( req, &poll_list, struct poll_req, entry )
-    {
-        unsigned int i;
-
-        for (i = 0; i < req->count; ++i)
-        {
-            if (req->sockets[i].sock != sock) continue;
-
-            ev |= poll_flags_from_afd( sock, req->sockets[i].flags );
-        }
-    }
+    LIST_FOR_EACH_ENTRY( poll, &sock->poll_list, struct poll_entry, entry )
+        ev |= poll_flags_from_afd( sock, poll->flags );
 
     return ev;
 }
@@ -1335,7 +1347,7 @@ static int sock_close_handle( struct object *obj, struct process *process, obj_h
     if (sock->obj.handle_count == 1) /* last handle */
     {
         struct accept_req *accept_req, *accept_next;
-        struct poll_req *poll_req, *poll_next;
+        struct poll_entry *poll;
 
         if (sock->accept_recv_req)
             async_terminate( sock->accept_recv_req->async, STATUS_CANCELLED );
@@ -1346,25 +1358,21 @@ static int sock_close_handle( struct object *obj, struct process *process, obj_h
         if (sock->connect_req)
             async_terminate( sock->connect_req->async, STATUS_CANCELLED );
 
-        LIST_FOR_EACH_ENTRY_SAFE( poll_req, poll_next, &poll_list, struct poll_req, entry )
+        while ((poll = find_pending_poll( sock, 0 )))
         {
-            struct iosb *iosb = poll_req->iosb;
-            BOOL signaled = FALSE;
+            struct poll_req *poll_req = poll->req;
             unsigned int i;
 
-            if (iosb->status != STATUS_PENDING) continue;
-
             for (i = 0; i < poll_req->count; ++i)
             {
                 if (poll_req->sockets[i].sock == sock)
                 {
-                    signaled = TRUE;
                     poll_req->output[i].flags = AFD_POLL_CLOSE;
                     poll_req->output[i].status = 0;
                 }
             }
 
-            if (signaled) complete_async_poll( poll_req, STATUS_SUCCESS );
+            complete_async_poll( poll_req, STATUS_SUCCESS );
         }
     }
 
@@ -1444,6 +1452,7 @@ static struct sock *create_socket(void)
     init_async_queue( &sock->poll_q );
     memset( sock->errors, 0, sizeof(sock->errors) );
     list_init( &sock->accept_list );
+    list_init( &sock->poll_list );
     return sock;
 }
 
@@ -2943,6 +2952,7 @@ static void poll_socket( struct sock *poll_sock, struct async *async, int exclus
             return;
         }
         req->sockets[i].flags = input[i].flags;
+        req->sockets[i].req = req;
     }
 
     req->exclusive = exclusive;
@@ -2954,6 +2964,8 @@ static void poll_socket( struct sock *poll_sock, struct async *async, int exclus
     handle_exclusive_poll(req);
 
     list_add_tail( &poll_list, &req->entry );
+    for (i = 0; i < count; ++i)
+        list_add_tail( &req->sockets[i].sock->poll_list, &req->sockets[i].entry );
     async_set_completion_callback( async, free_poll_req, req );
     queue_async( &poll_sock->poll_q, async );
 